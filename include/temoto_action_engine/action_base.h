@@ -24,6 +24,7 @@
 #include "temoto_action_engine/umrf.h"
 #include "temoto_action_engine/temoto_error.h"
 #include "temoto_action_engine/messaging.h"
+#include "temoto_action_engine/cancellation_token.h"
 
 /**
  * @brief This is the abstract base action that every action has to inherit and implement
@@ -71,12 +72,13 @@ public:
   }
 
   /**
-   * @brief Sets the STOP_REQUESTED_ member variable to "true" which is used by actionOk()
+   * @brief Requests the action to stop via its cancellation token, which is used by actionOk() and
+   * waitForStopOr(). Actions that are waiting on the token are woken up immediately.
    * 
    */
   bool stopAction()
   {
-    STOP_REQUESTED_ = true;
+    cancellation_token_.requestStop();
     return true;
   }
 
@@ -107,7 +109,34 @@ protected:
    */
   bool actionOk()
   {
-    return !STOP_REQUESTED_;
+    return !cancellation_token_.stopRequested();
+  }
+
+  /**
+   * @brief Sleeps for the given duration, unless the action is required to stop, in which case it
+   * returns immediately. Should be used instead of plain sleeps in action loops.
+   * 
+   * @tparam Rep 
+   * @tparam Period 
+   * @param duration 
+   * @return true if the action is required to stop
+   * @return false if the duration passed
+   */
+  template <class Rep, class Period>
+  bool waitForStopOr(const std::chrono::duration<Rep, Period>& duration)
+  {
+    return cancellation_token_.waitFor(duration);
+  }
+
+  /**
+   * @brief Get the cancellation token of the action, e.g., to register a stop callback which interrupts
+   * a blocking call
+   * 
+   * @return CancellationToken& 
+   */
+  CancellationToken& getCancellationToken()
+  {
+    return cancellation_token_;
   }
 
   /**
@@ -134,7 +163,7 @@ private:
     }
   }
 
-  bool STOP_REQUESTED_ = false;
+  CancellationToken cancellation_token_;
   std::shared_ptr<Umrf> umrf_;
 };
 #endif
\ No newline at end of file
@@ -30,11 +30,23 @@
 class ActionEngine
 {
 public:
-  ActionEngine();
+  /**
+   * @brief Construct a new Action Engine object
+   * 
+   * @param worker_count Number of worker threads started up front. More workers are started when all of them are
+   * busy (see ActionExecutor::ActionExecutor)
+   * @param probe_action_libraries If true, then the action libraries are probed for action classes when
+   * the actions are indexed, so that broken libraries are rejected before execution and the classes are
+   * not enumerated when the actions are executed
+   * @param max_worker_count Maximum number of worker threads, i.e., the maximum number of concurrently running actions
+   */
+  ActionEngine(unsigned int worker_count = ActionExecutor::DEFAULT_WORKER_COUNT
+  , bool probe_action_libraries = false
+  , unsigned int max_worker_count = ActionExecutor::DEFAULT_MAX_WORKER_COUNT);
 
   void start();
 
-  void executeUmrfGraph(UmrfGraph umrf_graph, bool name_match_required = false);
+  void executeUmrfGraph(const UmrfGraph& umrf_graph, bool name_match_required = false);
 
   void modifyGraph(const std::string& graph_name, const UmrfGraphDiffs& graph_diffs);
 
@@ -42,6 +54,14 @@ public:
   
   void addActionsPath(const std::string& action_packages_path);
 
+  /**
+   * @brief If enabled, then the action libraries stay loaded after their actions have finished, which
+   * speeds up repeated executions of the same actions
+   * 
+   * @param keep_warm 
+   */
+  void setLibraryKeepWarm(bool keep_warm);
+
   ~ActionEngine();
 private:
   ActionExecutor ae_;
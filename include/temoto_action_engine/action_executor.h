@@ -21,12 +21,20 @@
 #include <future>
 #include <vector>
 #include <map>
+#include <memory>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <algorithm>
 #include "temoto_action_engine/compiler_macros.h"
 #include "temoto_action_engine/umrf.h"
 #include "temoto_action_engine/umrf_graph.h"
 #include "temoto_action_engine/action_handle.h"
 #include "temoto_action_engine/umrf_graph_diff.h"
+#include "temoto_action_engine/thread_pool.h"
+#include "temoto_action_engine/action_library_cache.h"
+#include "temoto_action_engine/slot_map.h"
 
 /**
  * @brief Handles loading and execution of TeMoto Actions
@@ -35,7 +43,22 @@
 class ActionExecutor
 {
 public:
-  ActionExecutor();
+  /// Default number of worker threads started up front. Each running action occupies a worker for its whole duration.
+  static const unsigned int DEFAULT_WORKER_COUNT = 32;
+
+  /// Default maximum number of worker threads, i.e., the maximum number of concurrently running actions
+  static const unsigned int DEFAULT_MAX_WORKER_COUNT = 256;
+
+  /**
+   * @brief Construct a new Action Executor object
+   * 
+   * @param worker_count Number of worker threads started up front. If an action becomes ready while all workers
+   * are busy, then an additional worker is started for it, so that long running actions cannot block the rest of
+   * the graph. The additional workers exit once they have been idle for a while.
+   * @param max_worker_count Maximum number of worker threads. Actions that become ready beyond that wait
+   * until a running action finishes.
+   */
+  ActionExecutor(unsigned int worker_count = DEFAULT_WORKER_COUNT, unsigned int max_worker_count = DEFAULT_MAX_WORKER_COUNT);
 
   /**
    * @brief Starts the action executor
@@ -54,15 +77,41 @@ public:
   void notifyFinished(const unsigned int& parent_action_id, const ActionParameters& parent_action_parameters);
 
   /**
-   * @brief Executes actions in a graph specified its' unique ID.
+   * @brief Invoked by the action thread right before it returns (regardless of whether the action finished
+   * or failed). Queues the action for the cleanup loop and wakes it up. Non-blocking.
+   * 
+   * @param action_handle 
+   */
+  void notifyCompleted(const std::shared_ptr<ActionHandle>& action_handle);
+
+  /**
+   * @brief Returns the cache of action libraries, which is shared by all action handles of this executor
+   * 
+   * @return ActionLibraryCache& 
+   */
+  ActionLibraryCache& getLibraryCache();
+
+  /**
+   * @brief Invoked by the action handles on every state transition, keeps track of the number of running
+   * actions. Non-blocking.
+   * 
+   * @param old_state 
+   * @param new_state 
+   */
+  void notifyStateChange(const ActionHandle::State& old_state, const ActionHandle::State& new_state);
+
+  /**
+   * @brief Executes actions in a graph specified its' unique ID. The action libraries are loaded and the actions
+   * are instantiated without holding the executor locks, which are acquired only for publishing the action handles.
+   * Hence this method must not be called while holding the executor locks.
    * 
    * @param ids Identifiers of the actions to be executed
-   * @param ugh Graph where the actions are part of
+   * @param graph_name Name of the graph where the actions are part of
    * @param initialized_requrired If true then non of the actions are executed if some action is still in
    * uninitialized state (required input parameters not received). This is a required state when root nodes
    * of the action graph are executed.
    */
-  void executeById(const std::vector<unsigned int> ids, UmrfGraph& ugh, bool initialized_requrired = false);
+  void executeById(const std::vector<unsigned int>& ids, const std::string& graph_name, bool initialized_requrired = false);
 
   /**
    * @brief Returns the number of actions that are active in the ActionExecutor
@@ -72,10 +121,17 @@ public:
   unsigned int getActionCount() const;
 
   /**
-   * @brief Checks if any action is actively running 
+   * @brief Checks if any action is actively running. Does not lock the registries.
    */
   bool isActive() const;
 
+  /**
+   * @brief Returns the number of actions that are in running state. Does not lock the registries.
+   * 
+   * @return unsigned int 
+   */
+  unsigned int getRunningActionCount() const;
+
   /**
    * @brief Stops all actively running actions and the synchronous action cleanup loop
    * 
@@ -97,7 +153,8 @@ public:
    * @brief Creates and stores a UMRF graph object
    * 
    * @param graph_name 
-   * @param umrfs_vec Umrf vector based on which the graph will be built
+   * @param umrfs_vec Umrf vector based on which the graph will be built. Taken by value and moved into
+   * the graph, hence callers that don't need the UMRFs anymore should std::move them in.
    */
   void addUmrfGraph(const std::string& graph_name, std::vector<Umrf> umrfs_vec);
 
@@ -140,19 +197,29 @@ public:
 
 private:
   /**
-   * @brief Updates UMRFs of the associated action handles
+   * @brief Updates UMRFs of the associated action handles. Requires named_action_handles_rw_mutex_ and
+   * named_umrf_graphs_rw_mutex_ to be locked.
    * 
    * @param umrf_vec 
    */
   void updateActionHandles(const UmrfGraph& ugh, const std::vector<Umrf>& umrf_vec);
 
   /**
-   * @brief Executes the cleanup loop which will remove all synchronous actions that have
-   * finished executing.
+   * @brief Executes the cleanup loop, which sleeps until actions are reported via notifyCompleted
+   * and then cleans them up (see cleanupAction). Does no work while no actions complete.
    * 
    */
   void cleanupLoop();
 
+  /**
+   * @brief Retrieves the result of a completed action. If a synchronous action has finished, then
+   * its graph node is marked as finished and the graph is removed once all of its nodes have finished.
+   * Completions of handles that are no longer registered are ignored.
+   * 
+   * @param action_handle 
+   */
+  void cleanupAction(const std::shared_ptr<ActionHandle>& action_handle);
+
   /**
    * @brief Starts the cleanup loop in its own thread
    * 
@@ -161,26 +228,101 @@ private:
    */
   bool startCleanupLoopThread();
 
+  /**
+   * @brief Reserves a slot in the action handle registry and returns its ID. The ID stays valid until
+   * the action is removed from its graph or the graph is removed. Requires named_action_handles_rw_mutex_
+   * to be locked.
+   * 
+   * @return unsigned int 
+   */
   unsigned int createId();
 
-  std::string name_ = "Action Engine Name Test";
-  std::future<void> cleanup_loop_future_;
-  bool cleanup_loop_spinning_ = false;
-  unsigned int action_handle_id_count_ = 0;
-
   /*
    * TODO: These typedefs are there because otherwise the GUARDED_VARIABLE
    * macro will treat the comma in the map<> definition as a variable separator.
    * There should be more approproate way for doing this
    */ 
-  typedef std::map<unsigned int, ActionHandle> HandleMap;
+  typedef SlotMap<std::shared_ptr<ActionHandle>> HandleMap;
   typedef std::map<std::string, UmrfGraph> UmrfGraphMap;
+  typedef std::map<unsigned int, std::string> ActionGraphIndex;
 
-  mutable MUTEX_TYPE_R named_action_handles_rw_mutex_;
+  /**
+   * @brief Finds the graph which contains the given action. Requires named_umrf_graphs_rw_mutex_ to be locked.
+   * 
+   * @param action_id 
+   * @return UmrfGraphMap::iterator named_umrf_graphs_.end() if the action is not part of any graph
+   */
+  UmrfGraphMap::iterator findGraphOf(const unsigned int& action_id);
+
+  /**
+   * @brief Removes the graph along with its entries in the action-to-graph index, and releases the
+   * IDs of its actions. The handles of the actions are moved to erased_action_handles, which should
+   * be passed to clearActionHandles once the locks are released. Requires named_action_handles_rw_mutex_
+   * and named_umrf_graphs_rw_mutex_ to be locked.
+   * 
+   * @param graph_it 
+   * @param erased_action_handles 
+   */
+  void eraseUmrfGraph(UmrfGraphMap::iterator graph_it, std::vector<std::shared_ptr<ActionHandle>>& erased_action_handles);
+
+  /**
+   * @brief Stops the actions and empties the vector. Must be called without holding the executor locks,
+   * because stopping an action may wait for it to finish.
+   * 
+   * @param action_handles 
+   */
+  void clearActionHandles(std::vector<std::shared_ptr<ActionHandle>>& action_handles);
+
+  /**
+   * @brief Sets the nodes of the actions into error state, if the graph still exists. If none of the nodes
+   * of the graph is active anymore, then the graph is removed.
+   * 
+   * @param graph_name 
+   * @param action_ids 
+   */
+  void setGraphNodesError(const std::string& graph_name, const std::vector<unsigned int>& action_ids);
+
+  /**
+   * @brief Removes the handle of the action. The ID of the action stays reserved. The handle is moved to
+   * erased_action_handles, which should be passed to clearActionHandles once the locks are released.
+   * Requires named_action_handles_rw_mutex_ to be locked.
+   * 
+   * @param action_handle_id 
+   * @param erased_action_handles 
+   */
+  void eraseActionHandle(const unsigned int& action_handle_id, std::vector<std::shared_ptr<ActionHandle>>& erased_action_handles);
+
+  std::string name_ = "Action Engine Name Test";
+  std::future<void> cleanup_loop_future_;
+  bool cleanup_loop_spinning_ = false;
+
+  /// Actions that have completed but are not yet cleaned up. Guards also cleanup_loop_spinning_
+  std::mutex completed_action_ids_mutex_;
+  std::condition_variable completed_action_ids_cv_;
+  std::queue<std::weak_ptr<ActionHandle>> completed_action_handles_;
+
+  /// Number of action handles in RUNNING state, updated via notifyStateChange
+  std::atomic<unsigned int> running_action_count_;
+
+  /// Declared before the action handles, so that the libraries kept warm are unloaded after the actions are destroyed
+  ActionLibraryCache library_cache_;
+
+  /*
+   * The registries are guarded by readers-writer locks, i.e., queries share the lock and only modifications
+   * of the registries are exclusive. The locks are not recursive. If both are needed, then the handles are
+   * locked before the graphs.
+   */
+  mutable MUTEX_TYPE_RW named_action_handles_rw_mutex_;
   GUARDED_VARIABLE(HandleMap named_action_handles_, named_action_handles_rw_mutex_);
 
-  mutable MUTEX_TYPE_R named_umrf_graphs_rw_mutex_;
+  mutable MUTEX_TYPE_RW named_umrf_graphs_rw_mutex_;
   GUARDED_VARIABLE(UmrfGraphMap named_umrf_graphs_, named_umrf_graphs_rw_mutex_);
+
+  /// Resolves an action ID to the name of the graph that contains the action
+  GUARDED_VARIABLE(ActionGraphIndex action_graph_index_, named_umrf_graphs_rw_mutex_);
+
+  /// Executes the actions. Declared last so that the workers are joined before other members are destroyed.
+  ThreadPool thread_pool_;
 };
 
 #endif
@@ -19,25 +19,28 @@
 #ifndef TEMOTO_ACTION_ENGINE__ACTION_HANDLE_H
 #define TEMOTO_ACTION_ENGINE__ACTION_HANDLE_H
 
-#include <map>
 #include <memory>
 #include <string>
 #include <future>
+#include <atomic>
 #include <class_loader/class_loader.hpp>
 #include <boost/shared_ptr.hpp>
 #include "temoto_action_engine/compiler_macros.h"
 #include "temoto_action_engine/umrf.h"
 #include "temoto_action_engine/temoto_error.h"
+#include "temoto_action_engine/thread_pool.h"
 
 // Forward declare the action executor object
 class ActionExecutor;
 class ActionBase;
 
 /**
- * @brief 
+ * @brief Manages the lifecycle of a single action instance. The handle is kept compact as large graphs
+ * may have tens of thousands of handles: it is non-copyable, owned via std::shared_ptr and all of its
+ * members besides the state are guarded by a single mutex.
  * 
  */
-class ActionHandle
+class ActionHandle : public std::enable_shared_from_this<ActionHandle>
 {
 public:
 
@@ -53,17 +56,13 @@ public:
     ERROR,              // Problems with any critical component of the action
   };
 
-  /// A convenience datastructure which helps to convert state names to std::string
-  std::map<State, std::string> state_to_str_map_ = 
-  {
-    {State::UNINITIALIZED, "UNINITIALIZED"},
-    {State::INITIALIZED, "INITIALIZED"},
-    {State::READY, "READY"},
-    {State::RUNNING, "RUNNING"},
-    {State::STOP_REQUESTED, "STOP_REQUESTED"},
-    {State::FINISHED, "FINISHED"},
-    {State::ERROR, "ERROR"},
-  };
+  /**
+   * @brief Converts the state to a human readable string
+   * 
+   * @param state 
+   * @return const char* Statically allocated name of the state
+   */
+  static const char* stateToStr(State state);
 
   /**
    * @brief Construct a new Action Handle object
@@ -73,16 +72,19 @@ public:
    */
   ActionHandle(Umrf umrf, ActionExecutor* action_executor_ptr);
 
-  /// Copy constructor
-  ActionHandle(const ActionHandle& action_handle);
+  ActionHandle(const ActionHandle& action_handle) = delete;
+
+  ActionHandle& operator=(const ActionHandle& action_handle) = delete;
 
   ~ActionHandle();
 
   /**
-   * @brief Non-blocking call for executing the action in its own thread
+   * @brief Non-blocking call for executing the action on a worker thread of the thread pool. The queued
+   * task keeps the handle alive, hence the handle must be owned by a std::shared_ptr.
    * 
+   * @param thread_pool Pool that provides the worker thread
    */
-  void executeActionThread();
+  void executeActionThread(ThreadPool& thread_pool);
 
   /**
    * @brief Creates an instance of the user defined action object. Does not execute the action.
@@ -98,6 +100,23 @@ public:
    */
   void stopAction(double timeout);
 
+  /**
+   * @brief Sets the stop request flag via BaseAction::stopRequested if the action is running. Non-blocking.
+   * 
+   * @return true if the action was running and the stop was requested
+   * @return false 
+   */
+  bool requestStop();
+
+  /**
+   * @brief Blocks until the action, which was requested to stop, returns. The action thread signals its
+   * return, hence the call returns as soon as the action does. If the deadline is reached, then the action
+   * is set to ERROR state and an error is thrown. Returns immediately if no stop was requested.
+   * 
+   * @param deadline 
+   */
+  void waitForStop(const std::chrono::steady_clock::time_point& deadline);
+
   /**
    * @brief Stops the action (ActionHandle::stopAction) and destroys the action instance object.
    * 
@@ -112,12 +131,36 @@ public:
 
   bool addInputParameters(ActionParameters action_parameters);
 
-  const State& getState() const;
+  State getState() const;
 
+  /**
+   * @brief Transitions the handle to the given state. Lock-free.
+   * 
+   * @param state_to_set 
+   * @return true 
+   * @return false if the handle is already in the given state or the transition is not legal
+   * (see ActionHandle::isLegalTransition)
+   */
   bool setState(State state_to_set);
 
+  /**
+   * @brief Transitions the handle to the given state only if it's currently in the expected state. Lock-free.
+   * 
+   * @param expected_state 
+   * @param state_to_set 
+   * @return true 
+   * @return false 
+   */
+  bool setState(State expected_state, State state_to_set);
+
   bool futureIsReady();
 
+  /**
+   * @brief Blocks until the action thread has returned. Returns immediately if the action was not executed.
+   * 
+   */
+  void waitForFuture();
+
   TemotoErrorStack getFutureValue();
 
   bool clearFuture();
@@ -132,24 +175,36 @@ private:
    */
   TemotoErrorStack executeAction();
 
-  bool future_retreived_;
-
-  mutable MUTEX_TYPE state_rw_mutex_;
-  GUARDED_VARIABLE(State state_, state_rw_mutex_);
-
-  mutable MUTEX_TYPE_R action_future_rw_mutex_;
-  GUARDED_VARIABLE(std::shared_ptr<std::future<TemotoErrorStack>> action_future_, action_future_rw_mutex_);
-
-  mutable MUTEX_TYPE class_loader_rw_mutex_;
-  GUARDED_VARIABLE(std::shared_ptr<class_loader::ClassLoader> class_loader_, class_loader_rw_mutex_);
-
-  mutable MUTEX_TYPE action_instance_rw_mutex_;
-  GUARDED_VARIABLE(boost::shared_ptr<ActionBase> action_instance_, action_instance_rw_mutex_);
+  /**
+   * @brief Checks if the handle is allowed to transition between the given states. The regular lifecycle
+   * of a handle is UNINITIALIZED -> INITIALIZED -> READY -> RUNNING (-> STOP_REQUESTED) -> FINISHED.
+   * A handle may fall into ERROR from any state and is reset to INITIALIZED when the action is cleared.
+   * 
+   * @param from 
+   * @param to 
+   * @return true 
+   * @return false 
+   */
+  static bool isLegalTransition(State from, State to);
 
-  mutable MUTEX_TYPE_R umrf_rw_mutex_;
-  GUARDED_VARIABLE(std::shared_ptr<Umrf> umrf_, umrf_rw_mutex_);
+  /**
+   * @brief Returns a copy of the action future, so that it can be waited upon without holding handle_rw_mutex_
+   * 
+   * @return std::shared_future<TemotoErrorStack> 
+   */
+  std::shared_future<TemotoErrorStack> getFuture() const;
 
   /// Used for notifying the ActionExecutor when the action has finished execution.
   ActionExecutor* action_executor_ptr_;
+
+  std::atomic<State> state_;
+
+  /// Guards all members of the handle besides the state. The action is never executed while holding it
+  mutable MUTEX_TYPE_R handle_rw_mutex_;
+  GUARDED_VARIABLE(bool future_retreived_, handle_rw_mutex_);
+  GUARDED_VARIABLE(std::shared_future<TemotoErrorStack> action_future_, handle_rw_mutex_);
+  GUARDED_VARIABLE(std::shared_ptr<class_loader::ClassLoader> class_loader_, handle_rw_mutex_);
+  GUARDED_VARIABLE(boost::shared_ptr<ActionBase> action_instance_, handle_rw_mutex_);
+  GUARDED_VARIABLE(std::shared_ptr<Umrf> umrf_, handle_rw_mutex_);
 };
 #endif
\ No newline at end of file
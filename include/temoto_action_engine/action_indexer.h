@@ -20,6 +20,7 @@
 #define TEMOTO_ACTION_ENGINE__ACTION_INDEXER_H
 
 #include <vector>
+#include <map>
 #include <mutex>
 #include <utility>
 #include "boost/filesystem.hpp"
@@ -32,7 +33,17 @@
 class ActionIndexer
 {
 public:
-  ActionIndexer();
+  /// Maps an action library path to the names of the action classes that the library exports
+  typedef std::map<std::string, std::vector<std::string>> LibraryManifests;
+
+  /**
+   * @brief Construct a new Action Indexer object
+   * 
+   * @param probe_libraries If true, then each action library is loaded once during indexing in order to
+   * record the action classes it exports (see ActionIndexer::getLibraryManifests). Actions whose library
+   * is missing or does not export the action class are not indexed.
+   */
+  ActionIndexer(bool probe_libraries = false);
   /**
    * @brief Adds a base path where the ActionIndexer should look for action packages.
    * 
@@ -61,6 +72,14 @@ public:
    */
   const std::vector<Umrf>& getUmrfs() const;
 
+  /**
+   * @brief Returns the action classes of each library that was probed during last indexing. Empty if
+   * the libraries are not probed.
+   * 
+   * @return const LibraryManifests& 
+   */
+  const LibraryManifests& getLibraryManifests() const;
+
 private:
 
   /**
@@ -74,9 +93,24 @@ private:
                         , boost::filesystem::directory_entry base_path
                         , int search_depth);
 
+  /**
+   * @brief Checks if the library of the UMRF exports the action class. The library is probed only
+   * once, subsequent checks are resolved via library_manifests_.
+   * 
+   * @param umrf 
+   * @return true 
+   * @return false 
+   */
+  bool libraryContainsAction(const Umrf& umrf);
+
   /// Vector of timestamped semantic frames
   std::vector<Umrf> indexed_umrfs_;
 
+  /// Action classes of the probed libraries. Protected by action_sfs_mutex_
+  LibraryManifests library_manifests_;
+
+  bool probe_libraries_;
+
   /// Vector of action paths
   std::vector<std::string> action_paths_;
 
@@ -0,0 +1,104 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__ACTION_LIBRARY_CACHE_H
+#define TEMOTO_ACTION_ENGINE__ACTION_LIBRARY_CACHE_H
+
+#include <map>
+#include <set>
+#include <memory>
+#include <string>
+#include <vector>
+#include <class_loader/class_loader.hpp>
+#include "temoto_action_engine/compiler_macros.h"
+
+/**
+ * @brief Shares the class loaders of action libraries between action handles. A library is loaded once
+ * and stays loaded for as long as any action handle refers to it. If keep-warm is enabled, then the
+ * libraries stay loaded until the cache is cleared or destroyed.
+ *
+ */
+class ActionLibraryCache
+{
+public:
+  ActionLibraryCache(bool keep_warm = false);
+
+  ActionLibraryCache(const ActionLibraryCache& alc) = delete;
+
+  ActionLibraryCache& operator=(const ActionLibraryCache& alc) = delete;
+
+  /**
+   * @brief Returns the class loader of a library. The library is loaded if it's not loaded already.
+   *
+   * @param library_path
+   * @return std::shared_ptr<class_loader::ClassLoader>
+   */
+  std::shared_ptr<class_loader::ClassLoader> getClassLoader(const std::string& library_path);
+
+  /**
+   * @brief Checks if the library contains the given action class. The classes of a library are
+   * enumerated only once.
+   *
+   * @param library_path
+   * @param class_name
+   * @return true
+   * @return false
+   */
+  bool containsClass(const std::string& library_path, const std::string& class_name);
+
+  /**
+   * @brief Registers the classes of a library, e.g., when they are already known by the indexer. Registered
+   * libraries are not enumerated by containsClass.
+   *
+   * @param library_path
+   * @param class_names
+   */
+  void setClasses(const std::string& library_path, const std::vector<std::string>& class_names);
+
+  /**
+   * @brief If enabled, then the loaded libraries are not unloaded when they are not used anymore
+   *
+   * @param keep_warm
+   */
+  void setKeepWarm(bool keep_warm);
+
+  bool getKeepWarm() const;
+
+  /**
+   * @brief Releases the libraries that are kept warm. Libraries which are in use stay loaded.
+   *
+   */
+  void clear();
+
+private:
+  struct LibraryEntry
+  {
+    /// Guards the loading of this particular library, so that different libraries can be loaded concurrently
+    MUTEX_TYPE load_mutex_;
+    std::weak_ptr<class_loader::ClassLoader> class_loader_;
+    std::shared_ptr<class_loader::ClassLoader> warm_class_loader_;
+    bool classes_known_ = false;
+    std::set<std::string> class_names_;
+  };
+
+  std::shared_ptr<LibraryEntry> getEntry(const std::string& library_path);
+
+  typedef std::map<std::string, std::shared_ptr<LibraryEntry>> LibraryEntryMap;
+  mutable MUTEX_TYPE libraries_rw_mutex_;
+  GUARDED_VARIABLE(LibraryEntryMap libraries_, libraries_rw_mutex_);
+  GUARDED_VARIABLE(bool keep_warm_, libraries_rw_mutex_);
+};
+#endif
@@ -23,6 +23,7 @@
 #include <string>
 #include <map>
 #include "temoto_action_engine/temoto_error.h"
+#include "temoto_action_engine/name_atom.h"
 #include <boost/algorithm/string.hpp>
 
 /*
@@ -56,6 +57,7 @@ public:
   , required_(required)
   , updatable_(updatable)
   , quaranteed_(quaranteed)
+  , has_data_(false)
   {}
 
   ActionParameter(const ActionParameter<T>& ap)
@@ -67,23 +69,13 @@ public:
   , required_(ap.required_)
   , quaranteed_(ap.quaranteed_)
   , updatable_(ap.updatable_)
+  , has_data_(ap.has_data_)
   , data_(ap.data_)
   , allowed_data_(ap.allowed_data_)
   {}
 
-  // void operator=(const ActionParameter<T>& ap)
-  // {
-  //   name_ = ap.name_;
-  //   type_ = ap.type_;
-  //   example_ = ap.example_;
-  //   source_id_ = ap.source_id_;
-  //   timestamp_ = ap.timestamp_;
-  //   required_ = ap.required_;
-  //   quaranteed_ = ap.quaranteed_;
-  //   updatable_ = ap.updatable_;
-  //   data_ = ap.data_;
-  //   allowed_data_ = ap.allowed_data_;
-  // }
+  /// Declared explicitly because the implicit copy assignment is deprecated next to a user-declared copy constructor
+  ActionParameter& operator=(const ActionParameter<T>& ap) = default;
 
   ActionParameter(const std::string& name)
   : ActionParameter(name, "undef")
@@ -91,22 +83,39 @@ public:
 
   void setData(const T& data)
   {
-    data_.clear();
-    data_.push_back(data);
+    data_ = data;
+    has_data_ = true;
+  }
+
+  void setData(T&& data)
+  {
+    data_ = std::move(data);
+    has_data_ = true;
   }
 
   const T& getData() const
   {
-    if (data_.empty())
+    if (!has_data_)
     {
       throw CREATE_TEMOTO_ERROR_STACK("No data to retrieve");
     }
-    return data_.back();
+    return data_;
   }
 
+  /**
+   * @brief Returns the number of stored values. A parameter holds a single value, hence the size is 0 or 1.
+   * 
+   * @return unsigned int 
+   */
   unsigned int getDataSize() const
   {
-    return data_.size();
+    return has_data_ ? 1 : 0;
+  }
+
+  void clearData()
+  {
+    data_ = T();
+    has_data_ = false;
   }
 
   const int64_t& getSourceId() const
@@ -130,75 +139,81 @@ public:
   }
 
   const std::string& getName() const
+  {
+    return name_.str();
+  }
+
+  const NameAtom& getNameAtom() const
   {
     return name_;
   }
 
-  std::string getNameNoNamespace() const
+  /**
+   * @brief Returns the last segment of the name, e.g., "x" of "pose::position::x"
+   * 
+   * @return const std::string& 
+   */
+  const std::string& getNameNoNamespace() const
+  {
+    return name_.path().base_name.str();
+  }
+
+  /**
+   * @brief Returns the last segment of the name, i.e., same as getNameNoNamespace. Kept for compatibility,
+   * see getNamespaceName for the namespace of the parameter
+   * 
+   * @return const std::string& 
+   */
+  const std::string& getNamespace() const
+  {
+    return name_.path().base_name.str();
+  }
+
+  /**
+   * @brief Returns the name without the last segment, e.g., "pose::position" of "pose::position::x"
+   * 
+   * @return const std::string& 
+   */
+  const std::string& getNamespaceName() const
   {
-    std::vector<std::string> name_comp_vec;
-    boost::split(name_comp_vec, name_, boost::is_any_of("::"));
-    return name_comp_vec.back();
+    return name_.path().namespace_name.str();
   }
 
-   std::string getNamespace() const
+  const NamePath& getNamePath() const
   {
-    std::vector<std::string> name_comp_vec;
-    boost::split(name_comp_vec, name_, boost::is_any_of("::"));
-    return name_comp_vec.back();
+    return name_.path();
   }
 
   void setName(const std::string& name)
   {
-    name_ = name;
+    name_ = NameAtom(name);
   }
 
   void setNameKeepNamespace(const std::string& name)
   {
-    std::vector<std::string> name_comp_vec;
-    boost::split(name_comp_vec, name_, boost::is_any_of("::"));
-    
-    std::string final_name;
-    name_comp_vec.pop_back(); // Remove the name
-
-    for (const auto& name_comp : name_comp_vec)
-    {
-      if (name_comp.empty())
-      {
-        continue;
-      }
-      final_name += name_comp + "::";
-    }
-    final_name += name;
-    name_ = final_name;
+    const NameAtom& namespace_name = name_.path().namespace_name;
+    name_ = namespace_name.empty() ? NameAtom(name) : NameAtom(namespace_name.str() + "::" + name);
   }
 
+  /**
+   * @brief Removes the innermost namespace, e.g., "pose::position::x" becomes "pose::x"
+   * 
+   */
   void removeNamespaceLevel()
   {
-    std::vector<std::string> name_comp_vec;
-    boost::split(name_comp_vec, name_, boost::is_any_of("::"));
-    
-    if (name_comp_vec.size() == 1)
+    const NamePath& name_path = name_.path();
+    if (name_path.segments.size() <= 1)
     {
       return;
     }
 
-    std::string name_no_ns = name_comp_vec.back();
     std::string final_name;
-    name_comp_vec.pop_back(); // Remove the name
-    name_comp_vec.pop_back(); // Remove the empty char
-    name_comp_vec.pop_back(); // Remove the namespace
-
-    for (const auto& name_comp : name_comp_vec)
+    for (auto segment_it = name_path.segments.begin(); segment_it != name_path.segments.end() - 2; ++segment_it)
     {
-      if (name_comp.empty())
-      {
-        continue;
-      }
-      final_name += name_comp + "::";
+      final_name += segment_it->str() + "::";
     }
-    final_name += name_no_ns;
-    name_ = final_name;
+    final_name += name_path.base_name.str();
+    name_ = NameAtom(final_name);
   }
 
   const std::string& getType() const
@@ -223,7 +238,7 @@ public:
 
   /**
    * @brief Operator for maining parameters in std::set. The comparison operator must stay in this form, i.e.
-   * only the names should be compared.
+   * only the names should be compared. The parameters are ordered alphabetically by their names (see NameAtom).
    * 
    * @param rhs 
    * @return true 
@@ -231,7 +246,7 @@ public:
    */
   bool operator<(const ActionParameter<T>& rhs) const
   {
-    return name_ < rhs.getName();
+    return name_ < rhs.name_;
   }
 
   bool isEqualNoDataNoUpdate(const ActionParameter<T>& ap) const
@@ -267,7 +282,7 @@ public:
    */
   bool isEqual(const ActionParameter<T>& ap) const
   {
-    return (isEqualNoData(ap) && (data_.size() == ap.data_.size()));
+    return (isEqualNoData(ap) && (has_data_ == ap.has_data_));
   }
 
   bool isRequired() const
@@ -290,13 +305,8 @@ public:
     required_ = required;
   }
 
-  ~ActionParameter()
-  {
-    data_.clear();
-  }
-
 private:
-  std::string name_;
+  NameAtom name_;
   std::string type_;
   std::string example_;
   int64_t source_id_;
@@ -304,7 +314,8 @@ private:
   bool required_;
   bool updatable_;
   bool quaranteed_;
-  std::vector<T> data_;
+  bool has_data_;
+  T data_;
   std::vector<T> allowed_data_;
 };
 
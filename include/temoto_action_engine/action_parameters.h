@@ -22,10 +22,12 @@
 #include <vector>
 #include <set>
 #include <string>
+#include <utility>
 #include <algorithm>
 #include "temoto_action_engine/action_parameter.h"
+#include "temoto_action_engine/parameter_set.h"
+#include "temoto_action_engine/payload.h"
 #include "temoto_action_engine/temoto_error.h"
-#include "boost/any.hpp"
 
 /*
  * Action Parameters
@@ -33,9 +35,27 @@
 class ActionParameters
 {
 public:
-  typedef boost::any Payload;
+  typedef action_parameter::Payload Payload;
   typedef ActionParameter<Payload> ParameterContainer;
-  typedef std::set<ParameterContainer> Parameters;
+  typedef ParameterSet<ParameterContainer> Parameters;
+
+  /**
+   * @brief Precomputed transfer of parameters from a source parameter set (e.g., the outputs of a parent
+   * action) to this one. See createBindingPlan and applyBindingPlan.
+   * 
+   */
+  struct BindingPlan
+  {
+    bool resolved = false;
+
+    /// Names of the source and destination parameters the plan was computed for
+    std::vector<NameAtom> source_names;
+    std::vector<NameAtom> destination_names;
+
+    /// Positions (source index, destination index) of the parameters that are transferred from the source
+    /// to the destination. Valid as long as both parameter sets consist of the names above
+    std::vector<std::pair<std::size_t, std::size_t>> bound_indexes;
+  };
 
   ActionParameters()
   {}
@@ -48,6 +68,10 @@ public:
   : parameters_(a_parameters.parameters_)
   {}
 
+  ActionParameters(ActionParameters&& a_parameters) noexcept
+  : parameters_(std::move(a_parameters.parameters_))
+  {}
+
   ActionParameters& operator = (const ActionParameters& ap)
   {
     parameters_ = ap.parameters_;
@@ -55,6 +79,13 @@ public:
     // {
     //   parameters_.insert(p);
     // }
+    return *this;
+  }
+
+  ActionParameters& operator = (ActionParameters&& ap) noexcept
+  {
+    parameters_ = std::move(ap.parameters_);
+    return *this;
   }
 
   /**
@@ -69,8 +100,8 @@ public:
   {
     try
     {
-      auto local_parameter_it = parameters_.find(parameter_in);
-      if (local_parameter_it == parameters_.end())
+      ParameterContainer* local_parameter = parameters_.findNc(parameter_in.getNameAtom());
+      if (local_parameter == nullptr)
       {
         return parameters_.insert(parameter_in).second;
       }
@@ -79,33 +110,29 @@ public:
         /*
          * Modify the existing parameter. First check if the types match
          */
-        if (local_parameter_it->getType() != parameter_in.getType())
+        if (local_parameter->getType() != parameter_in.getType())
         {
           return false;
         }
 
         if (merge_new)
         {
-          // Insert the new param without keeping any info about the old param
-          parameters_.erase(local_parameter_it);
-          parameters_.insert(parameter_in);
+          // Replace the param without keeping any info about the old param
+          *local_parameter = parameter_in;
         }
         else
         {
           // Check if the "parameter-to-be-set" is restricted to certain data values
-          if (!checkParamAllowedData(*local_parameter_it, parameter_in))
+          if (!checkParamAllowedData(*local_parameter, parameter_in))
           {
             return false;
           }
 
-          // Create copy of the old parameter and assign it new params data
-          ParameterContainer param = *parameters_.find(parameter_in);
+          // Assign the new data to the old parameter in place
           if (parameter_in.getDataSize() != 0)
           {
-            param.setData(parameter_in.getData());
+            local_parameter->setData(parameter_in.getData());
           }
-          parameters_.erase(parameters_.find(parameter_in));          
-          parameters_.insert(param);
         }
       }
       return true;
@@ -125,15 +152,18 @@ public:
 
   template <class T> void setParameterData(const std::string& param_name, const T& data)
   {
-    ParameterContainer new_param = *parameters_.find(param_name);
-    new_param.setData(boost::any(data));
-    parameters_.erase(parameters_.find(param_name));
-    parameters_.insert(new_param);
+    ParameterContainer* parameter = findParameterNc(param_name);
+    if (parameter == nullptr)
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Could not find parameter '" + param_name + "'.");
+    }
+    parameter->setData(Payload(data));
   }
 
   /**
    * @brief Checks if the destination parameter is constrained to any particular allowed values or not.
-   * TODO: This method should be embedded into the ActionParameter<T> class via a generic comparison method.
+   * Only typed payloads (numbers, strings, etc.) can be compared, data of custom types never satisfies
+   * the restrictions.
    * 
    * @param param_dest
    * @param param_source 
@@ -147,26 +177,14 @@ public:
       return true;
     }
 
-    Payload param_source_data = param_source.getData();
+    const Payload& param_source_data = param_source.getData();
 
     // Check each allowed data instance
     for (const auto& allowed_dest_data : param_dest.getAllowedData())
     {
-      // TODO: due to the lack of knowledge, only generic types such as strings and numbers
-      // are checked. I guess one can serialize the data and compare it byte-by-byte ...
-      if (param_dest.getType() == "string")
+      if (allowed_dest_data == param_source_data)
       {
-        if (boost::any_cast<std::string>(allowed_dest_data) == boost::any_cast<std::string>(param_source_data))
-        {
-          return true;
-        }
-      }
-      else if (param_dest.getType() == "number")
-      {
-        if (boost::any_cast<double>(allowed_dest_data) == boost::any_cast<double>(param_source_data))
-        {
-          return true;
-        }
+        return true;
       }
     }
     return false;
@@ -211,13 +229,137 @@ public:
     }
   }
 
+  /**
+   * @brief Computes which parameters copyParameters would transfer from the given parameters, i.e., the
+   * parameter groups and types are resolved once instead of on every transfer.
+   * 
+   * @param params_in 
+   * @return BindingPlan 
+   */
+  BindingPlan createBindingPlan(const ActionParameters& params_in) const
+  {
+    BindingPlan binding_plan;
+    binding_plan.source_names = getNameAtoms(params_in.parameters_);
+    binding_plan.destination_names = getNameAtoms(parameters_);
+
+    std::set<std::string> param_names = getParamNames();
+    while(!param_names.empty())
+    {
+      std::set<std::string> params_in_group = checkParamSourceGroup(*parameters_.find(*param_names.begin()));
+      Parameters group_params_in = params_in.getParameterGroup(params_in_group);
+
+      bool all_params_correct = true;
+      for (const auto& param_in : group_params_in)
+      {
+        if (!hasParameter(param_in))
+        {
+          all_params_correct = false;
+          break;
+        }
+      }
+      if (all_params_correct)
+      {
+        for (const auto& param_in : group_params_in)
+        {
+          binding_plan.bound_indexes.emplace_back(
+            params_in.parameters_.indexOf(params_in.parameters_.find(param_in.getNameAtom()))
+          , parameters_.indexOf(parameters_.find(param_in.getNameAtom())));
+        }
+      }
+      for (const auto& param_in_group : params_in_group)
+      {
+        param_names.erase(param_in_group);
+      }
+    }
+    binding_plan.resolved = true;
+    return binding_plan;
+  }
+
+  /**
+   * @brief Transfers the parameters according to the binding plan. The plan is applied only if both parameter
+   * sets still consist of the parameters the plan was computed for, otherwise nothing is modified.
+   * 
+   * @param binding_plan 
+   * @param params_in 
+   * @return true if the plan was applied
+   * @return false if the plan does not match the parameters, i.e., copyParameters should be used instead
+   */
+  bool applyBindingPlan(const BindingPlan& binding_plan, const ActionParameters& params_in)
+  {
+    if (!binding_plan.resolved ||
+        !hasNameAtoms(params_in.parameters_, binding_plan.source_names) ||
+        !hasNameAtoms(parameters_, binding_plan.destination_names))
+    {
+      return false;
+    }
+
+    // The name sequences match, hence the parameters are at the same positions as when the plan was made.
+    // Verify the types before modifying anything
+    for (const auto& bound_index : binding_plan.bound_indexes)
+    {
+      if (parameters_.at(bound_index.second).getType() != params_in.parameters_.at(bound_index.first).getType())
+      {
+        return false;
+      }
+    }
+
+    for (const auto& bound_index : binding_plan.bound_indexes)
+    {
+      const ParameterContainer& param_source = params_in.parameters_.at(bound_index.first);
+      ParameterContainer& param_dest = parameters_.atNc(bound_index.second);
+
+      // Same semantics as setParameter: the data is assigned only if it's allowed by the destination
+      if (param_source.getDataSize() != 0 && checkParamAllowedData(param_dest, param_source))
+      {
+        param_dest.setData(param_source.getData());
+      }
+    }
+    return true;
+  }
+
   const ParameterContainer& getParameter(const std::string& name) const
   {
-    if (!hasParameter(name))
+    const ParameterContainer* parameter = findParameter(name);
+    if (parameter == nullptr)
     {
       throw CREATE_TEMOTO_ERROR("Could not find parameter '" + name + "'.");
     }
-    return *parameters_.find(name);
+    return *parameter;
+  }
+
+  /**
+   * @brief Looks up the parameter, i.e., a single lookup variant of hasParameter + getParameter
+   * 
+   * @param name 
+   * @return const ParameterContainer* nullptr if there is no such parameter
+   */
+  const ParameterContainer* findParameter(const std::string& name) const
+  {
+    auto parameter_it = parameters_.find(name);
+    return (parameter_it != parameters_.end()) ? &(*parameter_it) : nullptr;
+  }
+
+  const ParameterContainer* findParameter(const NameAtom& name) const
+  {
+    auto parameter_it = parameters_.find(name);
+    return (parameter_it != parameters_.end()) ? &(*parameter_it) : nullptr;
+  }
+
+  /**
+   * @brief Looks up the parameter for in-place modification. The name of the parameter must not be modified.
+   * 
+   * @param name 
+   * @return ParameterContainer* nullptr if there is no such parameter
+   */
+  ParameterContainer* findParameterNc(const std::string& name)
+  {
+    const NameAtom name_atom = NameAtom::lookup(name);
+    return name_atom.valid() ? parameters_.findNc(name_atom) : nullptr;
+  }
+
+  ParameterContainer* findParameterNc(const NameAtom& name)
+  {
+    return parameters_.findNc(name);
   }
 
   template <class T> T getParameterData(const std::string& name) const
@@ -227,7 +369,7 @@ public:
       const ParameterContainer& pc = getParameter(name);
       if (pc.getDataSize() > 0)
       {
-        return boost::any_cast<T>(pc.getData());
+        return pc.getData().template get<T>();
       }
       else
       {
@@ -260,11 +402,12 @@ public:
 
   bool removeParameter(const std::string& name)
   {
-    if (!hasParameter(name))
+    auto parameter_it = parameters_.find(name);
+    if (parameter_it == parameters_.end())
     {
       return false;
     }
-    parameters_.erase(parameters_.find(name));
+    parameters_.erase(parameter_it);
     return true;
   }
 
@@ -277,6 +420,7 @@ public:
     }
 
     // If all parameters are there then
+    parameters_out.reserve(param_names.size());
     for (const auto& param_name : param_names)
     {
       parameters_out.insert(*parameters_.find(param_name));
@@ -291,7 +435,7 @@ public:
 
   bool hasParameter(const ParameterContainer& param_in) const
   {
-    const auto& local_param_it = parameters_.find(param_in.getName());
+    const auto& local_param_it = parameters_.find(param_in.getNameAtom());
     if (local_param_it == parameters_.end() || local_param_it->getType() != param_in.getType())
     {
       return false;
@@ -302,6 +446,23 @@ public:
     }
   }
 
+  /**
+   * @brief Makes the data of all parameters keep the owner alive, e.g., the library of the action that
+   * produced the data. The data itself is not copied.
+   * 
+   * @param owner 
+   */
+  void pinPayloads(const std::shared_ptr<const void>& owner)
+  {
+    parameters_.forEachNc([&owner](ParameterContainer& parameter)
+    {
+      if (parameter.getDataSize() != 0)
+      {
+        parameter.setData(parameter.getData().pinnedTo(owner));
+      }
+    });
+  }
+
   unsigned int getParameterCount() const
   {
     return parameters_.size();
@@ -367,6 +528,34 @@ private:
     return contains_all;
   }
 
+  static std::vector<NameAtom> getNameAtoms(const Parameters& parameters)
+  {
+    std::vector<NameAtom> name_atoms;
+    name_atoms.reserve(parameters.size());
+    for (const auto& parameter : parameters)
+    {
+      name_atoms.push_back(parameter.getNameAtom());
+    }
+    return name_atoms;
+  }
+
+  static bool hasNameAtoms(const Parameters& parameters, const std::vector<NameAtom>& name_atoms)
+  {
+    if (parameters.size() != name_atoms.size())
+    {
+      return false;
+    }
+    auto name_atom_it = name_atoms.begin();
+    for (const auto& parameter : parameters)
+    {
+      if (parameter.getNameAtom() != *name_atom_it++)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
   std::set<std::string> checkParamSourceGroup(const ParameterContainer& param_in) const
   {
     std::set<std::string> params_in_same_group;
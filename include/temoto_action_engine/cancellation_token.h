@@ -0,0 +1,154 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__CANCELLATION_TOKEN_H
+#define TEMOTO_ACTION_ENGINE__CANCELLATION_TOKEN_H
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * @brief Thread-safe stop flag which can be polled, waited upon and subscribed to. Used for
+ * cooperative cancellation of actions, i.e., the action decides when and how to stop, but is
+ * woken up as soon as the stop is requested.
+ *
+ */
+class CancellationToken
+{
+public:
+  typedef unsigned int CallbackId;
+
+  CancellationToken()
+  : stop_requested_(false)
+  , next_callback_id_(0)
+  {}
+
+  CancellationToken(const CancellationToken& ct) = delete;
+
+  CancellationToken& operator=(const CancellationToken& ct) = delete;
+
+  /**
+   * @brief Sets the stop flag, wakes up all waiting threads and invokes the registered callbacks.
+   * The callbacks are invoked by the calling thread, only on the first request.
+   *
+   * @return true if this was the first stop request
+   * @return false if the stop was already requested
+   */
+  bool requestStop()
+  {
+    std::map<CallbackId, std::function<void()>> callbacks;
+    {
+      std::lock_guard<std::mutex> guard_stop(stop_mutex_);
+      if (stop_requested_.exchange(true))
+      {
+        return false;
+      }
+      callbacks.swap(callbacks_);
+    }
+    stop_cv_.notify_all();
+
+    for (const auto& callback : callbacks)
+    {
+      callback.second();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Lock-free check of the stop flag
+   *
+   * @return true if the stop was requested
+   * @return false
+   */
+  bool stopRequested() const
+  {
+    return stop_requested_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Blocks until the stop is requested or the duration has passed, whichever comes first
+   *
+   * @tparam Rep
+   * @tparam Period
+   * @param duration
+   * @return true if the stop was requested
+   * @return false if the duration passed without a stop request
+   */
+  template <class Rep, class Period>
+  bool waitFor(const std::chrono::duration<Rep, Period>& duration) const
+  {
+    std::unique_lock<std::mutex> lock_stop(stop_mutex_);
+    return stop_cv_.wait_for(lock_stop, duration, [this]{ return stopRequested(); });
+  }
+
+  /**
+   * @brief Blocks until the stop is requested
+   *
+   */
+  void wait() const
+  {
+    std::unique_lock<std::mutex> lock_stop(stop_mutex_);
+    stop_cv_.wait(lock_stop, [this]{ return stopRequested(); });
+  }
+
+  /**
+   * @brief Registers a callback that is invoked when the stop is requested, e.g., to interrupt
+   * a blocking IO call. If the stop was already requested, then the callback is invoked immediately
+   * by the calling thread. Callbacks should be short and must not block.
+   *
+   * @param callback
+   * @return CallbackId which can be used to unregister the callback
+   */
+  CallbackId registerStopCallback(std::function<void()> callback)
+  {
+    CallbackId callback_id;
+    {
+      std::lock_guard<std::mutex> guard_stop(stop_mutex_);
+      callback_id = next_callback_id_++;
+      if (!stopRequested())
+      {
+        callbacks_.emplace(callback_id, std::move(callback));
+        return callback_id;
+      }
+    }
+    callback();
+    return callback_id;
+  }
+
+  /**
+   * @brief Unregisters a callback. Has no effect if the callback was already invoked.
+   *
+   * @param callback_id
+   */
+  void unregisterStopCallback(const CallbackId& callback_id)
+  {
+    std::lock_guard<std::mutex> guard_stop(stop_mutex_);
+    callbacks_.erase(callback_id);
+  }
+
+private:
+  std::atomic<bool> stop_requested_;
+  mutable std::mutex stop_mutex_;
+  mutable std::condition_variable stop_cv_;
+  std::map<CallbackId, std::function<void()>> callbacks_;
+  CallbackId next_callback_id_;
+};
+
+#endif
@@ -26,13 +26,20 @@
   #define MUTEX_TYPE_R action_engine::RecursiveMutex
   #define LOCK_GUARD_TYPE action_engine::LockGuard
   #define LOCK_GUARD_TYPE_R action_engine::RecursiveLockGuard
+  #define MUTEX_TYPE_RW action_engine::SharedMutex
+  #define LOCK_GUARD_TYPE_RW action_engine::ExclusiveLockGuard
+  #define SHARED_LOCK_GUARD_TYPE_RW action_engine::SharedLockGuard
   #define GUARDED_VARIABLE(var, mutex) var GUARDED_BY(mutex)
 #elif(__GNUC__)
   #include <mutex>
+  #include <shared_mutex>
   #define MUTEX_TYPE std::mutex
   #define MUTEX_TYPE_R std::recursive_mutex
   #define LOCK_GUARD_TYPE std::lock_guard<std::mutex>
   #define LOCK_GUARD_TYPE_R std::lock_guard<std::recursive_mutex>
+  #define MUTEX_TYPE_RW std::shared_timed_mutex
+  #define LOCK_GUARD_TYPE_RW std::lock_guard<std::shared_timed_mutex>
+  #define SHARED_LOCK_GUARD_TYPE_RW std::shared_lock<std::shared_timed_mutex>
   #define GUARDED_VARIABLE(var, mutex) var
 #endif
 
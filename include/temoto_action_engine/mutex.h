@@ -2,6 +2,7 @@
 #define BENCHMARK_MUTEX_H_
 
 #include <mutex>
+#include <shared_mutex>
 
 // Enable thread safety attributes only with clang.
 // The attributes can be safely erased when compiling with other compilers.
@@ -91,6 +92,20 @@ class CAPABILITY("mutex") RecursiveMutex {
   std::recursive_mutex mut_;
 };
 
+class CAPABILITY("mutex") SharedMutex {
+ public:
+  SharedMutex() {}
+
+  void lock() ACQUIRE() { mut_.lock(); }
+  void unlock() RELEASE() { mut_.unlock(); }
+  void lock_shared() ACQUIRE_SHARED() { mut_.lock_shared(); }
+  void unlock_shared() RELEASE_SHARED() { mut_.unlock_shared(); }
+  std::shared_timed_mutex& native_handle() { return mut_; }
+
+ private:
+  std::shared_timed_mutex mut_;
+};
+
 class SCOPED_CAPABILITY UniqueLock {
   typedef std::unique_lock<std::mutex> UniqueLockImp;
 
@@ -123,6 +138,26 @@ private:
   LockGuardImp lg_;
 };
 
+class SCOPED_CAPABILITY ExclusiveLockGuard {
+  typedef std::lock_guard< std::shared_timed_mutex > LockGuardImp;
+public:
+  ExclusiveLockGuard(SharedMutex& m) ACQUIRE(m) : lg_(m.native_handle()) {}
+  ~ExclusiveLockGuard() RELEASE() {}
+  LockGuardImp& native_handle() { return lg_; }
+private:
+  LockGuardImp lg_;
+};
+
+class SCOPED_CAPABILITY SharedLockGuard {
+  typedef std::shared_lock< std::shared_timed_mutex > LockGuardImp;
+public:
+  SharedLockGuard(SharedMutex& m) ACQUIRE_SHARED(m) : lg_(m.native_handle()) {}
+  ~SharedLockGuard() RELEASE() {}
+  LockGuardImp& native_handle() { return lg_; }
+private:
+  LockGuardImp lg_;
+};
+
 } // namespace action_engine
 
 #endif
@@ -0,0 +1,146 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__NAME_ATOM_H
+#define TEMOTO_ACTION_ENGINE__NAME_ATOM_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+
+struct NamePath;
+
+/**
+ * @brief Interned name. Each distinct string is stored once in a process-wide table and atoms of equal
+ * strings refer to the same table entry, hence equality and hashing of atoms are integer operations.
+ * Atoms are ordered alphabetically by their strings, so that the order does not depend on which names
+ * were interned first. The table is never shrunk, thus only names (action, relation and parameter names)
+ * should be interned.
+ *
+ */
+class NameAtom
+{
+public:
+  /**
+   * @brief Constructs an atom of the empty string
+   *
+   */
+  NameAtom();
+
+  /**
+   * @brief Interns the name, i.e., adds it to the table if it's not there already. Thread-safe.
+   *
+   * @param name
+   */
+  explicit NameAtom(const std::string& name);
+
+  /**
+   * @brief Returns the atom of the name without interning it. If the name is not interned, then the
+   * returned atom is not equal to any interned atom (see NameAtom::valid). Thread-safe.
+   *
+   * @param name
+   * @return NameAtom
+   */
+  static NameAtom lookup(const std::string& name);
+
+  const std::string& str() const
+  {
+    return entry_->first;
+  }
+
+  /**
+   * @brief Sequence number of the atom in the table
+   *
+   * @return unsigned int
+   */
+  unsigned int id() const
+  {
+    return entry_->second;
+  }
+
+  bool valid() const;
+
+  /**
+   * @brief Returns the name split into namespace segments, e.g., "pose::position::x". The path is computed
+   * once per interned name and shared by all atoms of the name. Thread-safe.
+   *
+   * @return const NamePath&
+   */
+  const NamePath& path() const;
+
+  bool empty() const
+  {
+    return entry_->first.empty();
+  }
+
+  bool operator==(const NameAtom& rhs) const
+  {
+    return entry_ == rhs.entry_;
+  }
+
+  bool operator!=(const NameAtom& rhs) const
+  {
+    return entry_ != rhs.entry_;
+  }
+
+  bool operator<(const NameAtom& rhs) const
+  {
+    return entry_ != rhs.entry_ && entry_->first < rhs.entry_->first;
+  }
+
+  size_t hash() const
+  {
+    return std::hash<const void*>()(entry_);
+  }
+
+  typedef std::pair<const std::string, unsigned int> Entry;
+
+private:
+  NameAtom(const Entry* entry)
+  : entry_(entry)
+  {}
+
+  /// Points to an entry of the process-wide table. Never null
+  const Entry* entry_;
+};
+
+/**
+ * @brief Hierarchical name, which is split at the namespace separators ("::"), e.g., the path of
+ * "pose::position::x" consists of segments "pose", "position" and "x", namespace "pose::position" and
+ * base name "x". Empty segments are skipped.
+ *
+ */
+struct NamePath
+{
+  std::vector<NameAtom> segments;
+  NameAtom namespace_name;
+  NameAtom base_name;
+};
+
+namespace std
+{
+  template <>
+  struct hash<NameAtom>
+  {
+    size_t operator()(const NameAtom& name_atom) const
+    {
+      return name_atom.hash();
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,204 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__PARAMETER_SET_H
+#define TEMOTO_ACTION_ENGINE__PARAMETER_SET_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include "temoto_action_engine/name_atom.h"
+
+/**
+ * @brief Contiguous container of action parameters, sorted by parameter name (see NameAtom). Offers the
+ * lookup and insertion interface of std::set, but the parameters are stored in a single vector, looked up
+ * via binary search on the interned names and can be modified in place.
+ *
+ * @tparam P Parameter type, must provide getNameAtom()
+ */
+template <class P>
+class ParameterSet
+{
+public:
+  typedef P value_type;
+  typedef typename std::vector<P>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+  const_iterator begin() const
+  {
+    return parameters_.begin();
+  }
+
+  const_iterator end() const
+  {
+    return parameters_.end();
+  }
+
+  size_t size() const
+  {
+    return parameters_.size();
+  }
+
+  bool empty() const
+  {
+    return parameters_.empty();
+  }
+
+  void clear()
+  {
+    parameters_.clear();
+  }
+
+  void reserve(size_t size)
+  {
+    parameters_.reserve(size);
+  }
+
+  const_iterator find(const NameAtom& name) const
+  {
+    auto parameter_it = lowerBound(name);
+    return (parameter_it != parameters_.end() && parameter_it->getNameAtom() == name) ? parameter_it : parameters_.end();
+  }
+
+  const_iterator find(const std::string& name) const
+  {
+    // A name which is not interned cannot be the name of any parameter
+    const NameAtom name_atom = NameAtom::lookup(name);
+    return name_atom.valid() ? find(name_atom) : parameters_.end();
+  }
+
+  const_iterator find(const P& parameter) const
+  {
+    return find(parameter.getNameAtom());
+  }
+
+  /**
+   * @brief Returns the parameter at the given position in the name order
+   *
+   * @param index Must be less than size()
+   * @return const P&
+   */
+  const P& at(size_t index) const
+  {
+    return parameters_[index];
+  }
+
+  /**
+   * @brief Returns the parameter at the given position for in-place modification. The name of the parameter
+   * must not be modified.
+   *
+   * @param index Must be less than size()
+   * @return P&
+   */
+  P& atNc(size_t index)
+  {
+    return parameters_[index];
+  }
+
+  /**
+   * @brief Returns the position of the parameter in the name order
+   *
+   * @param position Valid iterator of this set
+   * @return size_t
+   */
+  size_t indexOf(const_iterator position) const
+  {
+    return static_cast<size_t>(position - parameters_.begin());
+  }
+
+  /**
+   * @brief Returns the parameter for in-place modification. The name of the parameter must not be modified.
+   *
+   * @param name
+   * @return P* nullptr if there is no such parameter
+   */
+  P* findNc(const NameAtom& name)
+  {
+    auto parameter_it = lowerBound(name);
+    return (parameter_it != parameters_.end() && parameter_it->getNameAtom() == name) ? &(*parameter_it) : nullptr;
+  }
+
+  /**
+   * @brief Invokes the function with each parameter for in-place modification. The names of the parameters
+   * must not be modified.
+   *
+   * @tparam F Callable with signature void(P&)
+   * @param f
+   */
+  template <class F>
+  void forEachNc(F f)
+  {
+    for (auto& parameter : parameters_)
+    {
+      f(parameter);
+    }
+  }
+
+  /**
+   * @brief Inserts the parameter if there is no parameter with the same name
+   *
+   * @param parameter
+   * @return std::pair<const_iterator, bool> Position of the parameter with this name and whether the parameter
+   * was inserted
+   */
+  std::pair<const_iterator, bool> insert(P parameter)
+  {
+    auto parameter_it = lowerBound(parameter.getNameAtom());
+    if (parameter_it != parameters_.end() && parameter_it->getNameAtom() == parameter.getNameAtom())
+    {
+      return std::make_pair(const_iterator(parameter_it), false);
+    }
+    return std::make_pair(const_iterator(parameters_.insert(parameter_it, std::move(parameter))), true);
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+    {
+      insert(*first);
+    }
+  }
+
+  const_iterator erase(const_iterator position)
+  {
+    return parameters_.erase(position);
+  }
+
+private:
+  typename std::vector<P>::iterator lowerBound(const NameAtom& name)
+  {
+    return std::lower_bound(parameters_.begin(), parameters_.end(), name
+    , [](const P& parameter, const NameAtom& name_in)
+      {
+        return parameter.getNameAtom() < name_in;
+      });
+  }
+
+  const_iterator lowerBound(const NameAtom& name) const
+  {
+    return std::lower_bound(parameters_.begin(), parameters_.end(), name
+    , [](const P& parameter, const NameAtom& name_in)
+      {
+        return parameter.getNameAtom() < name_in;
+      });
+  }
+
+  std::vector<P> parameters_;
+};
+
+#endif
@@ -0,0 +1,607 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__PAYLOAD_H
+#define TEMOTO_ACTION_ENGINE__PAYLOAD_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <boost/any.hpp>
+#include <boost/variant.hpp>
+#include "temoto_action_engine/temoto_error.h"
+
+namespace action_parameter
+{
+
+/**
+ * @brief Value of an action parameter. The common types (numbers, bools, strings, numeric arrays and shared
+ * binary blobs) are stored in typed storage and are read without type erasure. Any other type is stored in
+ * a boost::any, which keeps custom types working.
+ * 
+ * Floating point numbers, integers and bools are stored inline and are never heap allocated. Integers are
+ * kept exact, i.e., signed integers are stored as int64_t and unsigned integers as uint64_t. Strings are
+ * stored by value. Numeric arrays, blobs and custom types are heap allocated once and shared between the
+ * copies of the payload, hence copying a payload (e.g., when the output of an action is passed to its children)
+ * never copies their data. Shared numeric arrays and custom types are copied only if they are modified
+ * (see getMutablePtr).
+ *
+ */
+class Payload
+{
+public:
+  enum class Type : unsigned int
+  {
+    EMPTY,
+    NUMBER,
+    BOOL,
+    STRING,
+    NUMBER_ARRAY,
+    BLOB,
+    ANY,
+    INTEGER,
+    UNSIGNED_INTEGER
+  };
+
+  typedef std::vector<double> NumberArray;
+
+  /// Opaque binary data, shared between the copies of the payload
+  typedef std::shared_ptr<const std::vector<uint8_t>> Blob;
+
+private:
+  /// Types that are held in the typed storage
+  template <class T>
+  struct IsStored : std::integral_constant<bool,
+    std::is_same<T, double>::value ||
+    std::is_same<T, int64_t>::value ||
+    std::is_same<T, uint64_t>::value ||
+    std::is_same<T, bool>::value ||
+    std::is_same<T, std::string>::value ||
+    std::is_same<T, Blob>::value>
+  {};
+
+  /// Types that are converted to the typed storage by the constructors
+  template <class T>
+  struct IsTyped : std::integral_constant<bool,
+    std::is_arithmetic<T>::value ||
+    std::is_convertible<T, std::string>::value ||
+    std::is_same<T, NumberArray>::value ||
+    std::is_same<T, Blob>::value ||
+    std::is_same<T, boost::any>::value ||
+    std::is_same<T, Payload>::value>
+  {};
+
+public:
+  Payload()
+  : value_(boost::blank())
+  {}
+
+  /**
+   * @brief Stores any arithmetic type (besides bool) as a number. Floating point numbers are stored as double,
+   * signed integers as int64_t and unsigned integers as uint64_t, so that integers keep their exact value.
+   */
+  template <class T, class = typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type>
+  Payload(T number)
+  : value_(toNumber(number))
+  {}
+
+  Payload(bool boolean)
+  : value_(boolean)
+  {}
+
+  Payload(const char* string)
+  : value_(std::string(string))
+  {}
+
+  Payload(std::string string)
+  : value_(std::move(string))
+  {}
+
+  Payload(NumberArray number_array)
+  : value_(std::make_shared<const NumberArray>(std::move(number_array)))
+  {}
+
+  Payload(std::shared_ptr<const NumberArray> number_array)
+  : value_(std::move(number_array))
+  {}
+
+  Payload(Blob blob)
+  : value_(std::move(blob))
+  {}
+
+  /**
+   * @brief Stores the contents of the boost::any. Values of the common types are moved to the typed storage.
+   * 
+   * @param any 
+   */
+  Payload(const boost::any& any)
+  : value_(boost::blank())
+  {
+    if (any.empty())
+    {
+      return;
+    }
+    else if (const double* number = boost::any_cast<double>(&any))
+    {
+      value_ = *number;
+    }
+    else if (const int64_t* integer = boost::any_cast<int64_t>(&any))
+    {
+      value_ = *integer;
+    }
+    else if (const uint64_t* unsigned_integer = boost::any_cast<uint64_t>(&any))
+    {
+      value_ = *unsigned_integer;
+    }
+    else if (const bool* boolean = boost::any_cast<bool>(&any))
+    {
+      value_ = *boolean;
+    }
+    else if (const std::string* string = boost::any_cast<std::string>(&any))
+    {
+      value_ = *string;
+    }
+    else if (const NumberArray* number_array = boost::any_cast<NumberArray>(&any))
+    {
+      value_ = std::make_shared<const NumberArray>(*number_array);
+    }
+    else if (const Blob* blob = boost::any_cast<Blob>(&any))
+    {
+      value_ = *blob;
+    }
+    else
+    {
+      value_ = std::make_shared<const boost::any>(any);
+    }
+  }
+
+  /**
+   * @brief Stores a value of a custom type via boost::any
+   */
+  template <class T, class = typename std::enable_if<!IsTyped<T>::value>::type, class = void>
+  explicit Payload(T value)
+  : value_(std::make_shared<const boost::any>(std::move(value)))
+  {}
+
+  Type getType() const
+  {
+    return static_cast<Type>(value_.which());
+  }
+
+  bool empty() const
+  {
+    return getType() == Type::EMPTY;
+  }
+
+  /**
+   * @brief Returns the value as the given type. Numbers can be retrieved as any arithmetic type (via static_cast)
+   * and values of custom types as their original type.
+   * 
+   * @tparam T 
+   * @return T 
+   */
+  template <class T>
+  T get() const
+  {
+    if (const T* value = getPtr<T>())
+    {
+      return *value;
+    }
+    if (isNumber() && std::is_arithmetic<T>::value && !std::is_same<T, bool>::value)
+    {
+      return fromNumber<T>(std::integral_constant<bool, std::is_arithmetic<T>::value>());
+    }
+    throw CREATE_TEMOTO_ERROR_STACK("Cannot retrieve a payload of type " + std::string(typeToStr(getType()))
+      + " as the requested type.");
+  }
+
+  /**
+   * @brief Returns a pointer to the stored value without copying it. Unlike get(), numbers are not converted.
+   * 
+   * @tparam T 
+   * @return const T* nullptr if the payload does not hold a value of the given type
+   */
+  template <class T>
+  const T* getPtr() const
+  {
+    if (const T* value = getStored<T>())
+    {
+      return value;
+    }
+    if (const AnyPtr* any = boost::get<AnyPtr>(&value_))
+    {
+      return boost::any_cast<T>(any->get());
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Returns a pointer to the stored value, through which the value can be modified. Shared values
+   * (numeric arrays and custom types) are copied first, unless this payload is their only owner, hence
+   * the modifications never affect the other copies of the payload. Numbers are not converted.
+   * 
+   * @tparam T 
+   * @return T* nullptr if the payload does not hold a value of the given type
+   */
+  template <class T>
+  T* getMutablePtr()
+  {
+    const T* value = getPtr<T>();
+    if (value == nullptr)
+    {
+      return nullptr;
+    }
+    if (getType() == Type::ANY)
+    {
+      return boost::any_cast<T>(detach(boost::get<AnyPtr>(value_)));
+    }
+
+    // The rest of the values are held by value_ itself
+    return const_cast<T*>(value);
+  }
+
+  /**
+   * @brief Returns a copy of the payload whose shared data keeps the owner alive. Used for handing the outputs
+   * of an action over to other actions, as the data (and the code that destroys it) might originate from the
+   * library of the action, which must stay loaded for as long as the data exists.
+   * 
+   * @param owner 
+   * @return Payload 
+   */
+  Payload pinnedTo(const std::shared_ptr<const void>& owner) const
+  {
+    Payload payload(*this);
+
+    // The pinned value is still shared with this payload
+    payload.shared_value_owned_ = false;
+    switch (getType())
+    {
+      case Type::NUMBER_ARRAY:
+        payload.value_ = pin(boost::get<NumberArrayPtr>(value_), owner);
+        break;
+      case Type::BLOB:
+        payload.value_ = pin(boost::get<Blob>(value_), owner);
+        break;
+      case Type::ANY:
+        payload.value_ = pin(boost::get<AnyPtr>(value_), owner);
+        break;
+      default:
+        break;
+    }
+    return payload;
+  }
+
+  /**
+   * @brief Returns the value as boost::any
+   * 
+   * @return boost::any 
+   */
+  boost::any toAny() const
+  {
+    switch (getType())
+    {
+      case Type::NUMBER:
+        return boost::any(boost::get<double>(value_));
+      case Type::INTEGER:
+        return boost::any(boost::get<int64_t>(value_));
+      case Type::UNSIGNED_INTEGER:
+        return boost::any(boost::get<uint64_t>(value_));
+      case Type::BOOL:
+        return boost::any(boost::get<bool>(value_));
+      case Type::STRING:
+        return boost::any(boost::get<std::string>(value_));
+      case Type::NUMBER_ARRAY:
+        return boost::any(*boost::get<NumberArrayPtr>(value_));
+      case Type::BLOB:
+        return boost::any(boost::get<Blob>(value_));
+      case Type::ANY:
+        return *boost::get<AnyPtr>(value_);
+      default:
+        return boost::any();
+    }
+  }
+
+  /**
+   * @brief Compares the values of typed payloads. Numbers are compared by value regardless of how they are
+   * stored. Blobs are equal if they share the data. Payloads of custom types are never equal.
+   * 
+   * @param rhs 
+   * @return true 
+   * @return false 
+   */
+  bool operator==(const Payload& rhs) const
+  {
+    if (isNumber() && rhs.isNumber())
+    {
+      return numberEquals(rhs);
+    }
+    if (getType() != rhs.getType())
+    {
+      return false;
+    }
+    switch (getType())
+    {
+      case Type::EMPTY:
+        return true;
+      case Type::NUMBER:
+        return boost::get<double>(value_) == boost::get<double>(rhs.value_);
+      case Type::BOOL:
+        return boost::get<bool>(value_) == boost::get<bool>(rhs.value_);
+      case Type::STRING:
+        return boost::get<std::string>(value_) == boost::get<std::string>(rhs.value_);
+      case Type::NUMBER_ARRAY:
+        return *boost::get<NumberArrayPtr>(value_) == *boost::get<NumberArrayPtr>(rhs.value_);
+      case Type::BLOB:
+        return boost::get<Blob>(value_) == boost::get<Blob>(rhs.value_);
+      default:
+        return false;
+    }
+  }
+
+  bool operator!=(const Payload& rhs) const
+  {
+    return !(*this == rhs);
+  }
+
+  static const char* typeToStr(Type type)
+  {
+    static const char* const type_names[] =
+    {
+      "EMPTY",
+      "NUMBER",
+      "BOOL",
+      "STRING",
+      "NUMBER_ARRAY",
+      "BLOB",
+      "ANY",
+      "INTEGER",
+      "UNSIGNED_INTEGER"
+    };
+    return type_names[static_cast<unsigned int>(type)];
+  }
+
+private:
+  typedef std::shared_ptr<const NumberArray> NumberArrayPtr;
+  typedef std::shared_ptr<const boost::any> AnyPtr;
+
+  /// Keeps the owner alive for as long as the value exists. The owner is destroyed after the value
+  template <class V>
+  struct Pinned
+  {
+    std::shared_ptr<const void> owner;
+    std::shared_ptr<const V> value;
+  };
+
+  template <class V>
+  static std::shared_ptr<const V> pin(const std::shared_ptr<const V>& value, const std::shared_ptr<const void>& owner)
+  {
+    std::shared_ptr<Pinned<V>> pinned = std::make_shared<Pinned<V>>(Pinned<V>{owner, value});
+    return std::shared_ptr<const V>(pinned, pinned->value.get());
+  }
+
+  /**
+   * @brief Prepares a shared value for modification. The value is copied, unless it was copied by this
+   * function before and this payload is its only owner. Only such copies are not const objects.
+   */
+  template <class V>
+  V* detach(std::shared_ptr<const V>& value)
+  {
+    if (!shared_value_owned_ || value.use_count() != 1)
+    {
+      value = std::make_shared<V>(*value);
+      shared_value_owned_ = true;
+    }
+    return const_cast<V*>(value.get());
+  }
+
+  template <class T>
+  const T* getStored() const
+  {
+    return getIf<T>(IsStored<T>());
+  }
+
+  template <class T>
+  const T* getIf(std::true_type) const
+  {
+    return boost::get<T>(&value_);
+  }
+
+  template <class T>
+  const T* getIf(std::false_type) const
+  {
+    return nullptr;
+  }
+
+  bool isNumber() const
+  {
+    const Type type = getType();
+    return type == Type::NUMBER || type == Type::INTEGER || type == Type::UNSIGNED_INTEGER;
+  }
+
+  template <class T>
+  static double toNumber(T number, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr)
+  {
+    return static_cast<double>(number);
+  }
+
+  template <class T>
+  static int64_t toNumber(T number, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type* = nullptr)
+  {
+    return static_cast<int64_t>(number);
+  }
+
+  template <class T>
+  static uint64_t toNumber(T number, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type* = nullptr)
+  {
+    return static_cast<uint64_t>(number);
+  }
+
+  /// Requires both payloads to hold a number. Integers are compared exactly, otherwise as doubles
+  bool numberEquals(const Payload& rhs) const
+  {
+    if (getType() == Type::NUMBER || rhs.getType() == Type::NUMBER)
+    {
+      return fromNumber<double>(std::true_type()) == rhs.fromNumber<double>(std::true_type());
+    }
+    if (getType() == rhs.getType())
+    {
+      return (getType() == Type::INTEGER)
+        ? boost::get<int64_t>(value_) == boost::get<int64_t>(rhs.value_)
+        : boost::get<uint64_t>(value_) == boost::get<uint64_t>(rhs.value_);
+    }
+    const int64_t integer = (getType() == Type::INTEGER) ? boost::get<int64_t>(value_) : boost::get<int64_t>(rhs.value_);
+    const uint64_t unsigned_integer = (getType() == Type::INTEGER) ? boost::get<uint64_t>(rhs.value_) : boost::get<uint64_t>(value_);
+    return integer >= 0 && static_cast<uint64_t>(integer) == unsigned_integer;
+  }
+
+  template <class T>
+  T fromNumber(std::true_type) const
+  {
+    switch (getType())
+    {
+      case Type::INTEGER:
+        return static_cast<T>(boost::get<int64_t>(value_));
+      case Type::UNSIGNED_INTEGER:
+        return static_cast<T>(boost::get<uint64_t>(value_));
+      default:
+        return static_cast<T>(boost::get<double>(value_));
+    }
+  }
+
+  template <class T>
+  T fromNumber(std::false_type) const
+  {
+    throw CREATE_TEMOTO_ERROR_STACK("Cannot retrieve a number as a non-arithmetic type.");
+  }
+
+  /// The order of the types must match the Type enum
+  typedef boost::variant<boost::blank, double, bool, std::string, NumberArrayPtr, Blob, AnyPtr, int64_t, uint64_t> Value;
+  Value value_;
+
+  /// True if the shared value (numeric array or custom type) was copied by detach
+  bool shared_value_owned_ = false;
+};
+
+template <>
+inline const Payload::NumberArray* Payload::getStored<Payload::NumberArray>() const
+{
+  const NumberArrayPtr* number_array = boost::get<NumberArrayPtr>(&value_);
+  return (number_array == nullptr) ? nullptr : number_array->get();
+}
+
+template <>
+inline Payload::NumberArray* Payload::getMutablePtr<Payload::NumberArray>()
+{
+  NumberArrayPtr* number_array = boost::get<NumberArrayPtr>(&value_);
+  return (number_array == nullptr) ? nullptr : detach(*number_array);
+}
+
+template <>
+inline boost::any Payload::get<boost::any>() const
+{
+  return toAny();
+}
+
+template <>
+inline Payload Payload::get<Payload>() const
+{
+  return *this;
+}
+
+} // action_parameter namespace
+
+namespace boost
+{
+/**
+ * @brief Keeps the code that retrieves parameter data via boost::any_cast working. Returns a copy of the value,
+ * numbers are converted as in Payload::get.
+ * 
+ * @tparam T 
+ * @param payload 
+ * @return T 
+ * @throws boost::bad_any_cast if the payload does not hold a value of the given type
+ */
+template <class T>
+typename std::enable_if<!std::is_reference<T>::value, T>::type any_cast(const action_parameter::Payload& payload)
+{
+  try
+  {
+    return payload.get<typename std::decay<T>::type>();
+  }
+  catch(const TemotoErrorStack&)
+  {
+    throw boost::bad_any_cast();
+  }
+}
+
+/**
+ * @brief Const reference form of any_cast. Numbers are not converted.
+ * 
+ * @tparam T 
+ * @param payload 
+ * @return const std::remove_reference<T>::type& 
+ * @throws boost::bad_any_cast if the payload does not hold a value of the given type
+ */
+template <class T>
+typename std::enable_if<std::is_reference<T>::value, const typename std::remove_reference<T>::type&>::type
+any_cast(const action_parameter::Payload& payload)
+{
+  const typename std::decay<T>::type* value = payload.getPtr<typename std::decay<T>::type>();
+  if (value == nullptr)
+  {
+    throw boost::bad_any_cast();
+  }
+  return *value;
+}
+
+/**
+ * @brief Non-const reference form of any_cast, through which the value can be modified (see Payload::getMutablePtr).
+ * Numbers are not converted.
+ * 
+ * @tparam T 
+ * @param payload 
+ * @return T 
+ * @throws boost::bad_any_cast if the payload does not hold a value of the given type
+ */
+template <class T>
+typename std::enable_if<std::is_reference<T>::value && !std::is_const<typename std::remove_reference<T>::type>::value, T>::type
+any_cast(action_parameter::Payload& payload)
+{
+  typename std::decay<T>::type* value = payload.getMutablePtr<typename std::decay<T>::type>();
+  if (value == nullptr)
+  {
+    throw boost::bad_any_cast();
+  }
+  return *value;
+}
+
+/**
+ * @brief Pointer form of any_cast. Numbers are not converted.
+ * 
+ * @tparam T 
+ * @param payload 
+ * @return const T* nullptr if the payload is null or does not hold a value of the given type
+ */
+template <class T>
+const T* any_cast(const action_parameter::Payload* payload)
+{
+  return (payload == nullptr) ? nullptr : payload->getPtr<T>();
+}
+} // boost namespace
+
+#endif
@@ -0,0 +1,183 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__SLOT_MAP_H
+#define TEMOTO_ACTION_ENGINE__SLOT_MAP_H
+
+#include <vector>
+#include <deque>
+#include "temoto_action_engine/temoto_error.h"
+
+/**
+ * @brief Stores values in reusable slots which are addressed by generation tagged IDs. The lower
+ * INDEX_BITS of an ID address the slot and the upper bits hold the generation of the slot, which is
+ * incremented every time the slot is released. Hence an ID of a released slot does not resolve to
+ * the value that later reuses the slot. Released slots are reused in FIFO order and only once more
+ * than MIN_FREE_INDEXES slots are free, so an ID repeats only after the generation of its slot wraps
+ * around, i.e., after at least MIN_FREE_INDEXES * (GENERATION_MASK + 1) allocations. Not thread-safe.
+ *
+ * @tparam T Type of the stored value. Must be default constructible.
+ */
+template <class T>
+class SlotMap
+{
+public:
+  typedef unsigned int Id;
+
+  static const unsigned int INDEX_BITS = 20;
+  static const Id INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static const Id GENERATION_MASK = ~INDEX_MASK >> INDEX_BITS;
+
+  /// Number of released slots that are kept aside before the oldest of them is reused
+  static const unsigned int MIN_FREE_INDEXES = 1024;
+
+  /**
+   * @brief Reserves a slot which holds a default constructed value
+   *
+   * @return Id ID of the reserved slot
+   */
+  Id allocate()
+  {
+    unsigned int index;
+    if (free_indexes_.size() > MIN_FREE_INDEXES || (!free_indexes_.empty() && slots_.size() > INDEX_MASK))
+    {
+      index = free_indexes_.front();
+      free_indexes_.pop_front();
+    }
+    else if (slots_.size() <= INDEX_MASK)
+    {
+      index = slots_.size();
+      slots_.emplace_back();
+    }
+    else
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Cannot allocate an ID because all " + std::to_string(INDEX_MASK + 1)
+        + " slots are in use.");
+    }
+    slots_[index].allocated = true;
+    size_++;
+    return (slots_[index].generation << INDEX_BITS) | index;
+  }
+
+  /**
+   * @brief Releases the slot, i.e., destroys the value and invalidates the ID
+   *
+   * @param id
+   * @return true
+   * @return false if the ID is not valid
+   */
+  bool release(const Id& id)
+  {
+    Slot* slot = findSlot(id);
+    if (slot == nullptr)
+    {
+      return false;
+    }
+    slot->value = T();
+    slot->allocated = false;
+    slot->generation = (slot->generation + 1) & GENERATION_MASK;
+    free_indexes_.push_back(id & INDEX_MASK);
+    size_--;
+    return true;
+  }
+
+  /**
+   * @brief Returns the value of a slot
+   *
+   * @param id
+   * @return T* nullptr if the ID is not valid
+   */
+  T* find(const Id& id)
+  {
+    Slot* slot = findSlot(id);
+    return (slot == nullptr) ? nullptr : &slot->value;
+  }
+
+  const T* find(const Id& id) const
+  {
+    const Slot* slot = const_cast<SlotMap*>(this)->findSlot(id);
+    return (slot == nullptr) ? nullptr : &slot->value;
+  }
+
+  /**
+   * @brief Invokes the function with the ID and the value of each allocated slot
+   *
+   * @tparam F Callable with signature void(const Id&, T&)
+   * @param f
+   */
+  template <class F>
+  void forEach(F f)
+  {
+    for (unsigned int index=0; index<slots_.size(); index++)
+    {
+      if (slots_[index].allocated)
+      {
+        f((slots_[index].generation << INDEX_BITS) | index, slots_[index].value);
+      }
+    }
+  }
+
+  template <class F>
+  void forEach(F f) const
+  {
+    for (unsigned int index=0; index<slots_.size(); index++)
+    {
+      if (slots_[index].allocated)
+      {
+        f((slots_[index].generation << INDEX_BITS) | index, slots_[index].value);
+      }
+    }
+  }
+
+  /**
+   * @brief Returns the number of allocated slots
+   *
+   * @return unsigned int
+   */
+  unsigned int size() const
+  {
+    return size_;
+  }
+
+private:
+  struct Slot
+  {
+    T value;
+    Id generation = 0;
+    bool allocated = false;
+  };
+
+  Slot* findSlot(const Id& id)
+  {
+    unsigned int index = id & INDEX_MASK;
+    if (index >= slots_.size())
+    {
+      return nullptr;
+    }
+    Slot& slot = slots_[index];
+    if (!slot.allocated || slot.generation != (id >> INDEX_BITS))
+    {
+      return nullptr;
+    }
+    return &slot;
+  }
+
+  std::vector<Slot> slots_;
+  std::deque<unsigned int> free_indexes_;
+  unsigned int size_ = 0;
+};
+
+#endif
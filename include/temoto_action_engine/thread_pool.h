@@ -0,0 +1,213 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TEMOTO_ACTION_ENGINE__THREAD_POOL_H
+#define TEMOTO_ACTION_ENGINE__THREAD_POOL_H
+
+#include <list>
+#include <chrono>
+#include <algorithm>
+#include <queue>
+#include <memory>
+#include <thread>
+#include <future>
+#include <functional>
+#include <condition_variable>
+#include "temoto_action_engine/compiler_macros.h"
+#include "temoto_action_engine/temoto_error.h"
+
+/**
+ * @brief Pool of worker threads. Tasks are queued and executed in FIFO order by the first available
+ * worker. If a task is submitted while all workers are busy, then an additional worker is started,
+ * hence long running tasks cannot starve the queued ones, up to the maximum number of workers. Beyond
+ * that the tasks wait in the queue until a worker becomes available. The workers that were started on
+ * demand exit after being idle for the idle timeout, hence the pool shrinks back to its initial size.
+ *
+ */
+class ThreadPool
+{
+public:
+  /// Default time after which an idle worker, that was started on demand, exits
+  static constexpr double DEFAULT_IDLE_TIMEOUT = 10.0;
+
+  /**
+   * @brief Construct a new Thread Pool object and start the workers
+   *
+   * @param worker_count Number of worker threads that are started up front and kept for the lifetime
+   * of the pool. If 0 then a single worker is started.
+   * @param max_worker_count Maximum number of worker threads. If smaller than worker_count, then
+   * worker_count is used.
+   * @param idle_timeout Time in seconds after which an idle worker, that was started on demand, exits
+   */
+  ThreadPool(unsigned int worker_count, unsigned int max_worker_count, double idle_timeout = DEFAULT_IDLE_TIMEOUT)
+  : stopping_(false)
+  , idle_worker_count_(0)
+  , min_worker_count_((worker_count == 0) ? 1 : worker_count)
+  , max_worker_count_(std::max<std::size_t>(min_worker_count_, max_worker_count))
+  , idle_timeout_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(idle_timeout)))
+  {
+    std::lock_guard<std::mutex> guard_tasks(tasks_mutex_);
+    for (unsigned int i=0; i<min_worker_count_; i++)
+    {
+      startWorker();
+    }
+  }
+
+  ThreadPool(const ThreadPool& tp) = delete;
+
+  ThreadPool& operator=(const ThreadPool& tp) = delete;
+
+  /**
+   * @brief Queues a task for execution. Non-blocking.
+   *
+   * @tparam F Callable type
+   * @param task Callable that is invoked by a worker thread
+   * @return std::future Holds the return value of the task once it has been executed
+   */
+  template <class F>
+  std::future<typename std::result_of<F()>::type> submit(F task)
+  {
+    typedef typename std::result_of<F()>::type ReturnType;
+    auto packaged_task = std::make_shared<std::packaged_task<ReturnType()>>(std::move(task));
+    std::future<ReturnType> task_future = packaged_task->get_future();
+    {
+      std::lock_guard<std::mutex> guard_tasks(tasks_mutex_);
+      if (stopping_)
+      {
+        throw CREATE_TEMOTO_ERROR_STACK("Cannot submit a task because the thread pool is stopping.");
+      }
+      tasks_.emplace([packaged_task]{ (*packaged_task)(); });
+
+      // Every queued task needs an idle worker, otherwise it would wait for a busy worker to finish
+      if (tasks_.size() > idle_worker_count_ && workers_.size() < max_worker_count_)
+      {
+        startWorker();
+      }
+    }
+    tasks_cv_.notify_one();
+    return task_future;
+  }
+
+  /**
+   * @brief Returns the number of running worker threads
+   *
+   * @return unsigned int
+   */
+  unsigned int getWorkerCount() const
+  {
+    std::lock_guard<std::mutex> guard_tasks(tasks_mutex_);
+    return workers_.size();
+  }
+
+  /**
+   * @brief Stops accepting new tasks, discards the queued ones and joins the workers. Tasks
+   * that are already executing are allowed to finish.
+   *
+   */
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> guard_tasks(tasks_mutex_);
+      stopping_ = true;
+      std::queue<std::function<void()>>().swap(tasks_);
+    }
+    tasks_cv_.notify_all();
+
+    // The workers do not retire once the pool is stopping, hence the lists are not modified anymore
+    for (auto& worker : workers_)
+    {
+      if (worker.joinable())
+      {
+        worker.join();
+      }
+    }
+    joinRetiredWorkers();
+  }
+
+private:
+  typedef std::list<std::thread> Workers;
+
+  /// Requires tasks_mutex_ to be locked
+  void startWorker()
+  {
+    joinRetiredWorkers();
+
+    // The worker locks tasks_mutex_ before using its iterator, hence the thread is assigned by then
+    Workers::iterator worker_it = workers_.emplace(workers_.end());
+    *worker_it = std::thread(&ThreadPool::workerLoop, this, worker_it);
+    idle_worker_count_++;
+  }
+
+  /// Requires tasks_mutex_ to be locked, unless the pool is stopping
+  void joinRetiredWorkers()
+  {
+    // The retired workers have released tasks_mutex_ and do not lock it again before exiting
+    for (auto& worker : retired_workers_)
+    {
+      if (worker.joinable())
+      {
+        worker.join();
+      }
+    }
+    retired_workers_.clear();
+  }
+
+  void workerLoop(Workers::iterator worker_it)
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock_tasks(tasks_mutex_);
+        while (!tasks_cv_.wait_for(lock_tasks, idle_timeout_, [this]{ return stopping_ || !tasks_.empty(); }))
+        {
+          // Retire if this worker was started on demand. Its thread is joined by the next startWorker call
+          if (workers_.size() > min_worker_count_)
+          {
+            idle_worker_count_--;
+            retired_workers_.splice(retired_workers_.end(), workers_, worker_it);
+            return;
+          }
+        }
+        if (stopping_)
+        {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+        idle_worker_count_--;
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> guard_tasks(tasks_mutex_);
+        idle_worker_count_++;
+      }
+    }
+  }
+
+  bool stopping_;
+  std::size_t idle_worker_count_;
+  const std::size_t min_worker_count_;
+  const std::size_t max_worker_count_;
+  const std::chrono::steady_clock::duration idle_timeout_;
+  mutable std::mutex tasks_mutex_;
+  std::condition_variable tasks_cv_;
+  std::queue<std::function<void()>> tasks_;
+  Workers workers_;
+  Workers retired_workers_;
+};
+
+#endif
@@ -21,9 +21,11 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include "temoto_action_engine/compiler_macros.h"
 #include "temoto_action_engine/action_parameters.h"
+#include "temoto_action_engine/name_atom.h"
 
 namespace action_effect
 {
@@ -37,12 +39,16 @@ class Umrf
 {
 public:
   /**
-   * @brief Embeds infromation about a parent/child connection
+   * @brief Embeds infromation about a parent/child connection. The names are interned, hence relations
+   * are compared and resolved via integer operations.
    * 
    */
   struct Relation
   {
     Relation()
+    : suffix_(0)
+    , required_(true)
+    , received_(false)
     {}
 
     Relation(const std::string& name, const unsigned int& suffix, bool required = true)
@@ -50,29 +56,45 @@ public:
     , suffix_(suffix)
     , required_(required)
     , received_(false)
+    , full_name_(name + "_" + std::to_string(suffix))
+    {}
+
+    Relation(const NameAtom& name, const unsigned int& suffix, const NameAtom& full_name, bool required = true)
+    : name_(name)
+    , suffix_(suffix)
+    , required_(required)
+    , received_(false)
+    , full_name_(full_name)
     {}
 
     Relation(const Relation& r_in)
-    : name_(r_in.getName())
-    , suffix_(r_in.getSuffix())
-    , required_(r_in.getRequired())
-    , received_(r_in.getReceived())
+    : name_(r_in.name_)
+    , suffix_(r_in.suffix_)
+    , required_(r_in.required_)
+    , received_(r_in.received_)
+    , full_name_(r_in.full_name_)
     {}
 
     void operator=(const Relation& r_in)
     {
-      name_ = r_in.getName();
-      suffix_ = r_in.getSuffix();
-      required_ = r_in.getRequired();
-      received_ = r_in.getReceived();
+      name_ = r_in.name_;
+      suffix_ = r_in.suffix_;
+      required_ = r_in.required_;
+      received_ = r_in.received_;
+      full_name_ = r_in.full_name_;
     }
 
     bool operator==(const Relation& r_in) const
     {
-      return (name_ == r_in.getName()) && (suffix_ == r_in.getSuffix());
+      return (name_ == r_in.name_) && (suffix_ == r_in.suffix_);
     }
 
     const std::string& getName() const
+    {
+      return name_.str();
+    }
+
+    const NameAtom& getNameAtom() const
     {
       return name_;
     }
@@ -92,9 +114,14 @@ public:
       return received_;
     }
 
-    std::string getFullName() const
+    const std::string& getFullName() const
+    {
+      return full_name_.str();
+    }
+
+    const NameAtom& getFullNameAtom() const
     {
-      return name_ + "_" + std::to_string(suffix_);
+      return full_name_;
     }
 
     bool empty() const
@@ -102,25 +129,54 @@ public:
       return name_.empty();
     }
 
-    std::string name_;
+    NameAtom name_;
     unsigned int suffix_;
     bool required_; // Indicates whether the child can only execute once the parent has finished the execution  
     bool received_; // Indicates whether the parent has finished execution. Applies only to parent-type relations
+    NameAtom full_name_; // Name and suffix of the relation, i.e., the full name of the related UMRF
+  };
+
+  /**
+   * @brief Static part of the UMRF, i.e., the fields that describe the action and don't change during the
+   * execution. The descriptor is shared between copies of the UMRF and copied only when a copy modifies it
+   * (copy-on-write), hence copying an UMRF does not copy these strings.
+   * 
+   */
+  struct Descriptor
+  {
+    bool operator==(const Descriptor& d_in) const
+    {
+      return (name_ == d_in.name_) &&
+        (package_name_ == d_in.package_name_) &&
+        (description_ == d_in.description_) &&
+        (notation_ == d_in.notation_) &&
+        (effect_ == d_in.effect_) &&
+        (library_path_ == d_in.library_path_);
+    }
+
+    NameAtom name_;
+    std::string package_name_;
+    std::string description_;
+    std::string notation_;
+    std::string effect_;
+    std::string library_path_;
   };
 
   Umrf();
 
   Umrf(const Umrf& uj);
 
+  /**
+   * @brief Move constructor. The mutexes are not moved, i.e., the source must not be accessed concurrently.
+   * 
+   * @param uj 
+   */
+  Umrf(Umrf&& uj) noexcept;
+
   void operator=(const Umrf& umrf)
   {
-    name_ = umrf.name_;
-    package_name_ = umrf.package_name_;
-    description_ = umrf.description_;
+    descriptor_ = umrf.descriptor_;
     suffix_ = umrf.suffix_;
-    notation_ = umrf.notation_;
-    effect_ = umrf.effect_;
-    library_path_ = umrf.library_path_;
     parents_ = umrf.parents_;
     children_ = umrf.children_;
     id_ = umrf.id_;
@@ -129,10 +185,22 @@ public:
     output_parameters_ = umrf.output_parameters_;
   }
 
+  void operator=(Umrf&& umrf) noexcept
+  {
+    descriptor_ = umrf.descriptor_;
+    suffix_ = umrf.suffix_;
+    parents_ = std::move(umrf.parents_);
+    children_ = std::move(umrf.children_);
+    id_ = umrf.id_;
+    full_name_ = std::move(umrf.full_name_);
+    input_parameters_ = std::move(umrf.input_parameters_);
+    output_parameters_ = std::move(umrf.output_parameters_);
+  }
+
   bool isEqual(const Umrf& umrf_in, bool check_updatable = true) const;
 
   const std::string& getName() const;
-  std::string& getNameNc();
+  const NameAtom& getNameAtom() const;
   bool setName(const std::string& name);
 
   const std::string& getPackageName() const;
@@ -148,6 +216,7 @@ public:
   bool setNotation(const std::string& notation);
 
   const std::string& getFullName() const;
+  const NameAtom& getFullNameAtom() const;
 
   const std::string& getLibraryPath() const;
   bool setLibraryPath(const std::string& library_path);
@@ -177,6 +246,19 @@ public:
   bool setInputParameter(const ActionParameters::ParameterContainer& param_in);
 
   bool copyInputParameters(const ActionParameters& action_parameters);
+
+  /**
+   * @brief Copies the input parameters according to a binding plan (see createInputBindingPlan). Falls back
+   * to the regular copy if the plan does not match the parameters anymore.
+   * 
+   * @param action_parameters 
+   * @param binding_plan 
+   * @return true if all required input parameters are received
+   * @return false 
+   */
+  bool copyInputParameters(const ActionParameters& action_parameters, const ActionParameters::BindingPlan& binding_plan);
+
+  ActionParameters::BindingPlan createInputBindingPlan(const ActionParameters& action_parameters) const;
   
   bool inputParametersReceived() const;
 
@@ -193,6 +275,25 @@ public:
   bool requiredParentsFinished() const;
 
   void setParentReceived(const Umrf::Relation& parent);
+
+  /**
+   * @brief Marks the parent at the given position of the parents list as received
+   * 
+   * @param parent_index 
+   * @return true if the parent was not received before
+   * @return false 
+   */
+  bool setParentReceived(const unsigned int& parent_index);
+
+  /**
+   * @brief Makes this UMRF refer to the descriptor of the given UMRF, if the descriptors are equal. Used for
+   * deduplicating the descriptors of UMRFs that invoke the same action.
+   * 
+   * @param umrf 
+   * @return true if the descriptor is shared
+   * @return false 
+   */
+  bool shareDescriptor(const Umrf& umrf);
   
   ~Umrf()
   {
@@ -201,12 +302,17 @@ public:
   friend std::ostream& operator<<( std::ostream& stream, const Umrf& umrf);
   
 private:
-  std::string name_;
-  std::string package_name_;
-  std::string description_;
+  /**
+   * @brief Returns the descriptor for modification. If the descriptor is shared, then this UMRF gets its
+   * own copy of the descriptor first.
+   * 
+   * @return Descriptor& 
+   */
+  Descriptor& detachDescriptor();
+
+  /// Never null. Shared between the copies of this UMRF, hence must not be modified directly (see detachDescriptor)
+  std::shared_ptr<Descriptor> descriptor_;
   unsigned int suffix_ = 0;
-  std::string notation_;
-  std::string effect_;
   std::vector<Relation> parents_;
   std::vector<Relation> children_;
 
@@ -220,7 +326,6 @@ private:
    * Internal management variables
    */ 
   unsigned int id_;
-  std::string full_name_;
-  std::string library_path_;
+  NameAtom full_name_;
 };
 #endif
\ No newline at end of file
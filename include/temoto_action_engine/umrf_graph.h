@@ -28,6 +28,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <atomic>
 #include "temoto_action_engine/umrf.h"
 #include "compiler_macros.h"
 
@@ -43,10 +46,29 @@ struct GraphNode
   };
 
   GraphNode(const Umrf& umrf);
+  GraphNode(Umrf&& umrf);
   Umrf umrf_;
   State state_;
 
+  /// IDs of the child and parent nodes, resolved from the relations of the UMRF (see UmrfGraph::resolveRelationsOf)
+  std::vector<unsigned int> child_ids_;
+  std::vector<unsigned int> parent_ids_;
+
+  /// Marks a child which does not list this node as its parent (see UmrfGraph::validateRelations)
+  static const unsigned int NO_PARENT_SLOT = ~0u;
+
+  /// Position of this node in the parents list of each child, in the same order as child_ids_
+  std::vector<unsigned int> child_parent_slots_;
+
+  /// Transfer of the output parameters of this node to the inputs of each child, in the same order as child_ids_
+  std::vector<ActionParameters::BindingPlan> child_binding_plans_;
+
+  /// Number of required parents that have not finished yet. The node is ready to be executed when it reaches 0
+  std::atomic<unsigned int> nr_of_pending_required_parents_;
+
   GraphNode(const GraphNode& gn);
+
+  GraphNode(GraphNode&& gn);
 };
 
 class UmrfGraph
@@ -65,17 +87,55 @@ public:
 
   UmrfGraph(const std::string& graph_name, const std::vector<Umrf>& umrfs_vec, bool initialize_graph = true);
 
+  UmrfGraph(const std::string& graph_name, std::vector<Umrf>&& umrfs_vec, bool initialize_graph = true);
+
   UmrfGraph(const UmrfGraph& ugh);
 
+  /**
+   * @brief Move constructor. The mutexes are not moved, i.e., the source must not be accessed concurrently.
+   * 
+   * @param ugh 
+   */
+  UmrfGraph(UmrfGraph&& ugh);
+
   bool initialize(const std::vector<Umrf>& umrfs_vec);
 
+  /**
+   * @brief Same as initialize(const std::vector<Umrf>&), but the UMRFs are moved into the graph nodes
+   * 
+   * @param umrfs_vec 
+   * @return true 
+   * @return false 
+   */
+  bool initialize(std::vector<Umrf>&& umrfs_vec);
+
   const std::string getName() const;
 
   const std::string getDescription() const;
 
   void setDescription(const std::string description);
 
-  std::vector<unsigned int> getChildrenOf(const unsigned int& node_id) const;
+  const std::vector<unsigned int>& getChildrenOf(const unsigned int& node_id) const;
+
+  const std::vector<unsigned int>& getParentsOf(const unsigned int& node_id) const;
+
+  /**
+   * @brief Returns the binding plan of the output parameters of a node to the input parameters of its child
+   * 
+   * @param parent_id 
+   * @param child_index Index of the child in getChildrenOf(parent_id)
+   * @return const ActionParameters::BindingPlan& Unresolved plan if there is no such child
+   */
+  const ActionParameters::BindingPlan& getBindingPlanOf(const unsigned int& parent_id, const unsigned int& child_index) const;
+
+  /**
+   * @brief Marks the node as a finished parent of its children
+   * 
+   * @param parent_id ID of the finished node
+   * @return std::vector<unsigned int> IDs of the children which have no pending required parents left
+   * and are in UNINITIALIZED or INITIALIZED state, i.e., have not been executed yet
+   */
+  std::vector<unsigned int> markParentFinished(const unsigned int& parent_id);
 
   const Umrf& getUmrfOf(const unsigned int& node_id) const;
 
@@ -95,12 +155,32 @@ public:
 
   bool partOfGraph(const std::string& node_name) const;
 
+  bool partOfGraph(const NameAtom& node_name) const;
+
   const unsigned int& getNodeId(const std::string& node_name) const;
 
+  const unsigned int& getNodeId(const NameAtom& node_name) const;
+
   std::vector<unsigned int> getNodeIds() const;
 
+  /**
+   * @brief Checks that the parent and child relations of the nodes are symmetric, i.e., that each child lists
+   * its parent and vice versa. Not done by default, because the graph does not require it: a child which does
+   * not list its parent is executed once the parent finishes, but the parent does not count as its required parent.
+   * 
+   * @throws TemotoErrorStack describing the first asymmetric relation
+   */
+  void validateRelations() const;
+
   State checkState();
 
+  /**
+   * @brief Checks if any of the nodes is active, e.g., to tell whether a graph in ERROR state is done
+   * 
+   * @return true if at least one node is active
+   */
+  bool hasActiveNodes() const;
+
   /*
    * Methods for modifying the graph
    */
@@ -116,23 +196,65 @@ public:
 private:
   bool setNodeState(const unsigned int& node_id, GraphNode::State node_state);
 
+  /**
+   * @brief Returns the counter of nodes that are in the given state. Requires graph_nodes_map_rw_mutex_ to be locked.
+   * 
+   * @param node_state 
+   * @return unsigned int& 
+   */
+  unsigned int& getNodeStateCount(const GraphNode::State& node_state);
+
   bool findRootNodes();
 
   /**
-   * @brief Populates the graph_nodes_map_ and name_id_map_
+   * @brief Resolves the relations of all nodes (see resolveRelationsOf). Requires graph_nodes_map_rw_mutex_
+   * and name_id_map_rw_mutex_ to be locked.
+   * 
+   */
+  void resolveRelations();
+
+  /**
+   * @brief Resolves the relations of the given nodes (see resolveRelationsOf). Used after modifying the graph,
+   * so that only the nodes whose relations changed are resolved. Requires graph_nodes_map_rw_mutex_ and
+   * name_id_map_rw_mutex_ to be locked.
+   * 
+   * @param node_ids 
+   */
+  void resolveRelations(const std::set<unsigned int>& node_ids);
+
+  /**
+   * @brief Collects the node and its parents, i.e., the nodes that have to be resolved when the parents
+   * list of the node changes, as the parents refer to positions in that list. Requires name_id_map_rw_mutex_
+   * to be locked.
+   * 
+   * @param node_id 
+   * @param node_ids 
+   */
+  void collectWithParents(const unsigned int& node_id, std::set<unsigned int>& node_ids) const;
+
+  /**
+   * @brief Resolves the parent and child relations of a node to node IDs, computes the parameter binding plans
+   * to its children and counts its pending required parents. Requires graph_nodes_map_rw_mutex_ and name_id_map_rw_mutex_ to be locked.
+   * 
+   * @param graph_node 
+   */
+  void resolveRelationsOf(GraphNode& graph_node);
+
+  /**
+   * @brief Populates the graph_nodes_map_ and name_id_map_. The UMRFs are moved into the graph nodes
    * 
    * @return true 
    * @return false 
    */
-  bool createMaps(const std::vector<Umrf>& umrfs_vec);
+  bool createMaps(std::vector<Umrf>&& umrfs_vec);
 
   /// Helps to resolve UMRF id to a GraphNode
   typedef std::map<unsigned int, GraphNode> GraphNodeMap;
   mutable MUTEX_TYPE_R graph_nodes_map_rw_mutex_;
   GUARDED_VARIABLE(GraphNodeMap graph_nodes_map_, graph_nodes_map_rw_mutex_);
 
-  /// Helps to resolve UMRF (GraphNode) name to its ID
-  typedef std::map<std::string, unsigned int> NameToIdMap;
+  /// Helps to resolve UMRF (GraphNode) full name to its ID
+  typedef std::unordered_map<NameAtom, unsigned int> NameToIdMap;
   mutable MUTEX_TYPE_R name_id_map_rw_mutex_;
   GUARDED_VARIABLE(NameToIdMap name_id_map_, name_id_map_rw_mutex_);
 
@@ -151,10 +273,11 @@ private:
   // but the bug is just too mysterious and I am a mortal human with deadlines 
   mutable std::vector<Umrf> umrfs_vec_;
 
-  mutable unsigned int nr_of_uninitialized_nodes_ = 0;
-  mutable unsigned int nr_of_initialized_nodes_ = 0;
-  mutable unsigned int nr_of_active_nodes_ = 0;
-  mutable unsigned int nr_of_finished_nodes_ = 0;
-  mutable unsigned int nr_of_errored_nodes_ = 0;
+  /// Number of nodes per GraphNode::State, updated on every node state change (see setNodeState)
+  unsigned int nr_of_uninitialized_nodes_ = 0;
+  unsigned int nr_of_initialized_nodes_ = 0;
+  unsigned int nr_of_active_nodes_ = 0;
+  unsigned int nr_of_finished_nodes_ = 0;
+  unsigned int nr_of_errored_nodes_ = 0;
 };
 #endif
\ No newline at end of file
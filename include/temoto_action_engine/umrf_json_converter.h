@@ -61,11 +61,21 @@ static const struct RelationFields
   const char* required = "required";
 }RELATION_FIELDS;
 
-Umrf fromUmrfJsonStr(const std::string& umrf_json_str, bool as_descriptor = false);
+/**
+ * @brief Selects how UMRF JSON strings are parsed
+ * 
+ */
+enum class JsonParser
+{
+  DOM, ///< Parses the string into a JSON document, which is then converted
+  SAX  ///< Builds the UMRFs directly while reading the string, in a single pass
+};
+
+Umrf fromUmrfJsonStr(const std::string& umrf_json_str, bool as_descriptor = false, JsonParser parser = JsonParser::DOM);
 
 Umrf fromUmrfJsonValue(const rapidjson::Value& json_doc, bool as_descriptor = false);
 
-UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str);
+UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str, JsonParser parser = JsonParser::DOM);
 
 // std::vector<Umrf> fromUmrfListStr(const rapidjson::Value& json_doc);
 
@@ -19,7 +19,9 @@
 #include "temoto_action_engine/action_engine.h"
 #include "temoto_action_engine/messaging.h"
 
-ActionEngine::ActionEngine()
+ActionEngine::ActionEngine(unsigned int worker_count, bool probe_action_libraries, unsigned int max_worker_count)
+: ae_(worker_count, max_worker_count)
+, ai_(probe_action_libraries)
 {}
 
 void ActionEngine::start()
@@ -27,7 +29,12 @@ void ActionEngine::start()
   ae_.start();
 }
 
-void ActionEngine::executeUmrfGraph(UmrfGraph umrf_graph, bool name_match_required)
+void ActionEngine::setLibraryKeepWarm(bool keep_warm)
+{
+  ae_.getLibraryCache().setKeepWarm(keep_warm);
+}
+
+void ActionEngine::executeUmrfGraph(const UmrfGraph& umrf_graph, bool name_match_required)
 {
   std::vector<Umrf> umrf_vec_local = umrf_graph.getUmrfs();
 
@@ -57,12 +64,12 @@ void ActionEngine::executeUmrfGraph(UmrfGraph umrf_graph, bool name_match_requir
   if (ae_.graphExists(umrf_graph.getName()))
   {
     TEMOTO_PRINT("UMRF graph '" + umrf_graph.getName() + "' is already running. Trying to update the graph ...");
-    ae_.updateUmrfGraph(umrf_graph.getName(), umrf_vec_local);
+    ae_.updateUmrfGraph(umrf_graph.getName(), std::move(umrf_vec_local));
     TEMOTO_PRINT("UMRF graph '" + umrf_graph.getName() + "' updated");
   }
   else
   {
-    ae_.addUmrfGraph(umrf_graph.getName(), umrf_vec_local);
+    ae_.addUmrfGraph(umrf_graph.getName(), std::move(umrf_vec_local));
     TEMOTO_PRINT("UMRF graph '" + umrf_graph.getName() + "' initialized.");
 
     ae_.executeUmrfGraph(umrf_graph.getName());
@@ -86,6 +93,12 @@ void ActionEngine::addActionsPath(const std::string& action_packages_path)
   {
     ai_.addActionPath(action_packages_path);
     ai_.indexActions();
+
+    // Let the executor know the classes of the probed libraries
+    for (const auto& library_manifest : ai_.getLibraryManifests())
+    {
+      ae_.getLibraryCache().setClasses(library_manifest.first, library_manifest.second);
+    }
   }
   catch(TemotoErrorStack e)
   {
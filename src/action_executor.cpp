@@ -21,7 +21,9 @@
 #include "temoto_action_engine/messaging.h"
 #include <set>
  
-ActionExecutor::ActionExecutor()
+ActionExecutor::ActionExecutor(unsigned int worker_count, unsigned int max_worker_count)
+: running_action_count_(0)
+, thread_pool_(worker_count, max_worker_count)
 {}
 
 void ActionExecutor::start()
@@ -29,33 +31,68 @@ void ActionExecutor::start()
   startCleanupLoopThread();
 }
 
+ActionLibraryCache& ActionExecutor::getLibraryCache()
+{
+  return library_cache_;
+}
+
 void ActionExecutor::notifyFinished(const unsigned int& parent_action_id, const ActionParameters& parent_action_parameters)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
   /*
    * Check the UMRF graphs and execute sequential actions if necessary
    */
   try
   {
-    for (auto& umrf_graph_pair : named_umrf_graphs_)
+    std::string graph_name;
+    std::vector<unsigned int> ready_child_ids;
     {
-      if ((umrf_graph_pair.second.checkState() != UmrfGraph::State::ACTIVE) ||
-          (umrf_graph_pair.second.getChildrenOf(parent_action_id).empty()))
+      LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+
+      // Only the graph that owns the action is of interest
+      auto nug_it = findGraphOf(parent_action_id);
+      if (nug_it == named_umrf_graphs_.end())
       {
-        continue;
+        return;
+      }
+      graph_name = nug_it->first;
+      UmrfGraph& ugh = nug_it->second;
+
+      if ((ugh.checkState() != UmrfGraph::State::ACTIVE) ||
+          (ugh.getChildrenOf(parent_action_id).empty()))
+      {
+        return;
       }
 
       /*
        * Transfer the parameters from parent to child action
        */
-      for (const auto& child_id : umrf_graph_pair.second.getChildrenOf(parent_action_id))
+      std::set<unsigned int> params_received_child_ids;
+      const std::vector<unsigned int>& child_ids = ugh.getChildrenOf(parent_action_id);
+      for (unsigned int i=0; i<child_ids.size(); i++)
       {
-        Umrf& child_umrf = umrf_graph_pair.second.getUmrfOfNonconst(child_id);
-        child_umrf.copyInputParameters(parent_action_parameters);
-        child_umrf.setParentReceived(umrf_graph_pair.second.getUmrfOf(parent_action_id).asRelation());
+        const ActionParameters::BindingPlan& binding_plan = ugh.getBindingPlanOf(parent_action_id, i);
+        if (ugh.getUmrfOfNonconst(child_ids[i]).copyInputParameters(parent_action_parameters, binding_plan))
+        {
+          params_received_child_ids.insert(child_ids[i]);
+        }
       }
-      executeById(umrf_graph_pair.second.getChildrenOf(parent_action_id), umrf_graph_pair.second);
+
+      /*
+       * Find the children that have received all inputs and have no pending required parents
+       */
+      for (const auto& child_id : ugh.markParentFinished(parent_action_id))
+      {
+        if (params_received_child_ids.find(child_id) != params_received_child_ids.end())
+        {
+          ready_child_ids.push_back(child_id);
+        }
+      }
+    }
+
+    // The children are loaded without holding the executor locks
+    if (!ready_child_ids.empty())
+    {
+      executeById(ready_child_ids, graph_name);
     }
   }
   catch(TemotoErrorStack e)
@@ -70,50 +107,85 @@ void ActionExecutor::notifyFinished(const unsigned int& parent_action_id, const
 
 bool ActionExecutor::isActive() const
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  for (const auto& named_action_handle : named_action_handles_)
+  return running_action_count_ > 0;
+}
+
+unsigned int ActionExecutor::getRunningActionCount() const
+{
+  return running_action_count_;
+}
+
+void ActionExecutor::notifyStateChange(const ActionHandle::State& old_state, const ActionHandle::State& new_state)
+{
+  if (old_state == new_state)
   {
-    if (named_action_handle.second.getState() == ActionHandle::State::RUNNING)
-    {
-      return true;
-    }
+    return;
+  }
+  if (new_state == ActionHandle::State::RUNNING)
+  {
+    running_action_count_++;
+  }
+  else if (old_state == ActionHandle::State::RUNNING)
+  {
+    running_action_count_--;
   }
-  return false;
 }
 
 unsigned int ActionExecutor::getActionCount() const
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  return named_action_handles_.size();
+  SHARED_LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+  unsigned int action_count = 0;
+  named_action_handles_.forEach([&](const unsigned int&, const std::shared_ptr<ActionHandle>& action_handle)
+  {
+    if (action_handle)
+    {
+      action_count++;
+    }
+  });
+  return action_count;
 }
 
 bool ActionExecutor::stopAndCleanUp()
 {
-  named_action_handles_rw_mutex_.lock();
-  // Stop all actions
-  for (auto& named_action_handle : named_action_handles_)
+  // Request all actions to stop, so that they can stop concurrently
+  std::vector<std::shared_ptr<ActionHandle>> stopped_action_handles;
   {
-    TEMOTO_PRINT("Stopping action " + named_action_handle.second.getActionName());
-    named_action_handle.second.stopAction(4);
+    SHARED_LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    named_action_handles_.forEach([&](const unsigned int&, std::shared_ptr<ActionHandle>& action_handle)
+    {
+      if (action_handle && action_handle->requestStop())
+      {
+        TEMOTO_PRINT("Stopping action " + action_handle->getActionName());
+        stopped_action_handles.push_back(action_handle);
+      }
+    });
   }
-  named_action_handles_rw_mutex_.unlock();
 
   // Wait until all actions are stopped
   TEMOTO_PRINT("Waiting for all actions to stop ...");
-  while (isActive())
+  const auto stop_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+  for (const auto& action_handle : stopped_action_handles)
   {
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    try
+    {
+      action_handle->waitForStop(stop_deadline);
+    }
+    catch(TemotoErrorStack e)
+    {
+      std::cerr << e.what() << '\n';
+    }
   }
 
   // Stop the cleanup loop
   TEMOTO_PRINT("Stopping the cleanup loop ...");
-  cleanup_loop_spinning_ = false;
+  {
+    std::lock_guard<std::mutex> guard_completed(completed_action_ids_mutex_);
+    cleanup_loop_spinning_ = false;
+  }
+  completed_action_ids_cv_.notify_all();
   try
   {
-    while (cleanup_loop_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
-    {
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
+    cleanup_loop_future_.wait();
   }
   catch(const std::exception& e)
   {
@@ -126,105 +198,142 @@ bool ActionExecutor::stopAndCleanUp()
 
 bool ActionExecutor::startCleanupLoopThread()
 {
-  cleanup_loop_spinning_ = true;
+  {
+    std::lock_guard<std::mutex> guard_completed(completed_action_ids_mutex_);
+    cleanup_loop_spinning_ = true;
+  }
   cleanup_loop_future_ = std::async( std::launch::async
                                    , &ActionExecutor::cleanupLoop
                                    , this);
   return true;
 }
 
+void ActionExecutor::notifyCompleted(const std::shared_ptr<ActionHandle>& action_handle)
+{
+  {
+    std::lock_guard<std::mutex> guard_completed(completed_action_ids_mutex_);
+    completed_action_handles_.push(action_handle);
+  }
+  completed_action_ids_cv_.notify_one();
+}
+
 void ActionExecutor::cleanupLoop()
 {
-  while(cleanup_loop_spinning_)
+  while (true)
+  {
+    /*
+     * Sleep until an action completes or the loop is stopped
+     */
+    std::queue<std::weak_ptr<ActionHandle>> completed_action_handles;
+    {
+      std::unique_lock<std::mutex> lock_completed(completed_action_ids_mutex_);
+      completed_action_ids_cv_.wait(lock_completed, [this]
+      {
+        return !cleanup_loop_spinning_ || !completed_action_handles_.empty();
+      });
+      if (!cleanup_loop_spinning_)
+      {
+        return;
+      }
+      completed_action_handles.swap(completed_action_handles_);
+    }
+
+    while (!completed_action_handles.empty())
+    {
+      // If the handle is already destroyed, then it was stopped and erased in the meantime
+      std::shared_ptr<ActionHandle> action_handle = completed_action_handles.front().lock();
+      if (action_handle)
+      {
+        cleanupAction(action_handle);
+      }
+      completed_action_handles.pop();
+    }
+  }
+}
+
+void ActionExecutor::cleanupAction(const std::shared_ptr<ActionHandle>& action_handle)
+{
+  // The completion is pushed right before the action thread returns, hence the wait is brief. It's still
+  // done without holding the executor locks
+  action_handle->waitForFuture();
+
+  // The handles of an erased graph are cleared after the locks are released
+  std::vector<std::shared_ptr<ActionHandle>> erased_action_handles;
   {
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+
+    // The action might have been stopped, or replaced by a new execution of the same graph node
+    const unsigned int action_id = action_handle->getHandleId();
+    std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(action_id);
+    if (handle_slot == nullptr || *handle_slot != action_handle)
+    {
+      return;
+    }
+
+    try
     {
-      LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-      if (!named_action_handles_.empty())
+      std::string error_message = action_handle->getFutureValue().getMessage();
+      if (!error_message.empty())
+      {
+        std::cout << error_message << std::endl;
+      }
+
+      /*
+       * Both finished and failed actions are terminal nodes of the graph. Asynchronous actions that
+       * finished their execution keep running in the background and are not cleaned up here
+       */
+      const ActionHandle::State action_state = action_handle->getState();
+      const bool action_failed = (action_state == ActionHandle::State::ERROR);
+      if (!action_failed &&
+         ((action_state != ActionHandle::State::FINISHED) || (action_handle->getEffect() != "synchronous")))
       {
-        for ( auto nah_it=named_action_handles_.begin()
-            ; nah_it!=named_action_handles_.end()
-            ; /* empty */)
+        return;
+      }
+
+      /*
+       * The handle is kept (without the action instance) for as long as its graph exists, because
+       * the outputs it passed to the children may refer to the code in its action library. Once none of
+       * the nodes of the graph is active anymore, the graph is removed along with the handles of all its actions.
+       */
+      action_handle->clearAction();
+      auto nug_it = findGraphOf(action_id);
+      if (nug_it != named_umrf_graphs_.end())
+      {
+        UmrfGraph& ugh = nug_it->second;
+        if (action_failed)
         {
-          /*
-           * TODO: Handle actions that have reached to error state
-           */
-          if ((nah_it->second.getState() == ActionHandle::State::FINISHED) &&
-              nah_it->second.futureIsReady() &&
-              nah_it->second.getEffect() == "synchronous")
-          {
-            try
-            {
-              std::string error_message = nah_it->second.getFutureValue().getMessage();
-              if (!error_message.empty())
-              {
-                std::cout << error_message << std::endl;
-              }
-              // Notify the graph that the node has finished
-              {
-                LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
-                for ( auto nug_it=named_umrf_graphs_.begin()
-                    ; nug_it!=named_umrf_graphs_.end()
-                    ; nug_it++)
-                {
-                  if (!nug_it->second.partOfGraph(nah_it->first))
-                  {
-                    continue;
-                  }
-                  nug_it->second.setNodeFinished(nah_it->first);
-                }
-              }
-              nah_it->second.clearAction();
-              //named_action_handles_.erase(nah_it++); // TODO - currently the synchronous action handle is not erased but it should be ...
-              nah_it++;
-            }
-            catch(TemotoErrorStack e)
-            {
-              std::cout << e.what() << '\n';
-              ++nah_it;
-            }
-          }
-          else
-          {
-            ++nah_it;
-          }
+          ugh.setNodeError(action_id);
+        }
+        else
+        {
+          ugh.setNodeFinished(action_id);
         }
 
-        /*
-         * Remove all graphs and associated actions that have finished
-         */
-        LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
-        for ( auto nug_it=named_umrf_graphs_.begin()
-            ; nug_it!=named_umrf_graphs_.end()
-            ; /* empty */)
+        const UmrfGraph::State graph_state = ugh.checkState();
+        if (graph_state == UmrfGraph::State::FINISHED)
         {
-          if (nug_it->second.checkState() == UmrfGraph::State::FINISHED)
-          {
-            TEMOTO_PRINT("Graph '" + nug_it->first + "' has finished.");
-            // for (const auto& action_handle_id : nug_it->second.getNodeIds())
-            // {
-            //   TEMOTO_PRINT("erasing " + std::to_string(action_handle_id) + " ...");
-            //   named_action_handles_.erase(action_handle_id);
-            // }
-            named_umrf_graphs_.erase(nug_it++);
-          }
-          else
-          {
-            ++nug_it;
-          }
+          TEMOTO_PRINT("Graph '" + nug_it->first + "' has finished.");
+          eraseUmrfGraph(nug_it, erased_action_handles);
+        }
+        else if (graph_state == UmrfGraph::State::ERROR && !ugh.hasActiveNodes())
+        {
+          TEMOTO_PRINT("Graph '" + nug_it->first + "' has failed.");
+          eraseUmrfGraph(nug_it, erased_action_handles);
         }
       }
-      else
-      {
-        //TEMOTO_PRINT("no actions in executing state");
-      }
-    } // Lock guard scope
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    }
+    catch(TemotoErrorStack e)
+    {
+      std::cout << e.what() << '\n';
+    }
   }
+  clearActionHandles(erased_action_handles);
 }
 
 bool ActionExecutor::graphExists(const std::string& graph_name)
 {
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
+  SHARED_LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
   if (named_umrf_graphs_.find(graph_name) == named_umrf_graphs_.end())
   {
     // Graph does not exist
@@ -241,28 +350,40 @@ void ActionExecutor::addUmrfGraph(const std::string& graph_name, std::vector<Umr
 {
   try
   {
-    LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
 
     // Check if this UMRF graph exists
-    if (graphExists(graph_name))
+    if (named_umrf_graphs_.find(graph_name) != named_umrf_graphs_.end())
     {
-      CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name + "' is already added");
+      throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name + "' is already added");
     }
 
     // Give each UMRF a unique ID
+    std::vector<unsigned int> action_ids;
+    action_ids.reserve(umrfs_vec.size());
     for (auto& umrf_json : umrfs_vec)
     {
       umrf_json.setId(createId());
+      action_ids.push_back(umrf_json.getId());
     }
 
-    // Create an UMRF graph
-    UmrfGraph ugh = UmrfGraph(graph_name, umrfs_vec);
+    // Create an UMRF graph. The UMRFs are moved into the graph
+    UmrfGraph ugh(graph_name, std::move(umrfs_vec));
     if (ugh.checkState() == UmrfGraph::State::UNINITIALIZED)
     {
+      for (const auto& action_id : action_ids)
+      {
+        named_action_handles_.release(action_id);
+      }
       throw CREATE_TEMOTO_ERROR_STACK("Cannot add UMRF graph because it's uninitialized.");
     }
 
-    named_umrf_graphs_.insert(std::pair<std::string, UmrfGraph>(graph_name, ugh));
+    named_umrf_graphs_.emplace(graph_name, std::move(ugh));
+    for (const auto& action_id : action_ids)
+    {
+      action_graph_index_.emplace(action_id, graph_name);
+    }
   }
   catch(TemotoErrorStack e)
   {
@@ -272,12 +393,14 @@ void ActionExecutor::addUmrfGraph(const std::string& graph_name, std::vector<Umr
 
 void ActionExecutor::updateUmrfGraph(const std::string& graph_name, std::vector<Umrf> umrfs_vec)
 {
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
+  // Neither of the registries is modified, the UMRFs are updated via the action handles
+  SHARED_LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+  SHARED_LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
 
   try
   {
     // Check if this UMRF graph exists
-    if (!graphExists(graph_name))
+    if (named_umrf_graphs_.find(graph_name) == named_umrf_graphs_.end())
     {
       throw CREATE_TEMOTO_ERROR_STACK("Could not find UMRF graph '" + graph_name + "'");
     }
@@ -325,22 +448,20 @@ void ActionExecutor::updateUmrfGraph(const std::string& graph_name, std::vector<
 
 void ActionExecutor::updateActionHandles(const UmrfGraph& ugh, const std::vector<Umrf>& umrf_vec)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
   try
   {
     for (const auto& umrf_in : umrf_vec)
     {
       // Get handle id
-      const unsigned int& handle_id = ugh.getNodeId(umrf_in.getFullName());
-      if (named_action_handles_.find(handle_id) == named_action_handles_.end())
+      const unsigned int& handle_id = ugh.getNodeId(umrf_in.getFullNameAtom());
+      const std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(handle_id);
+      if (handle_slot == nullptr || !(*handle_slot))
       {
-        // This handle has finished execution
+        // This action has not been executed yet
         continue;
       }
 
-      ActionHandle& ah = named_action_handles_.at(handle_id);
-      ah.updateUmrf(umrf_in);
+      (*handle_slot)->updateUmrf(umrf_in);
     }
   }
   catch(TemotoErrorStack e)
@@ -351,103 +472,131 @@ void ActionExecutor::updateActionHandles(const UmrfGraph& ugh, const std::vector
 
 void ActionExecutor::modifyGraph(const std::string& graph_name, const UmrfGraphDiffs& graph_diffs)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
-
-  if (!graphExists(graph_name))
+  // The handles of the removed actions are stopped after the locks are released
+  std::vector<std::shared_ptr<ActionHandle>> erased_action_handles;
+  try
   {
-    TEMOTO_PRINT("Cannot modify graph '" + graph_name + "' because it does not exist.");
-    return;
-  }
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
 
-  TEMOTO_PRINT("Received a request to modify UMRF graph '" + graph_name + "' ...");
-  UmrfGraph& ugh = named_umrf_graphs_.at(graph_name);
+    if (named_umrf_graphs_.find(graph_name) == named_umrf_graphs_.end())
+    {
+      TEMOTO_PRINT("Cannot modify graph '" + graph_name + "' because it does not exist.");
+      return;
+    }
 
-  /*
-   * Before modyfing the graph, check if the graph contains the UMRFs which are menitoned in the diffs
-   */ 
-  for (const auto& graph_diff : graph_diffs)
-  {
-    if (graph_diff.operation == UmrfGraphDiff::Operation::add_umrf)
+    TEMOTO_PRINT("Received a request to modify UMRF graph '" + graph_name + "' ...");
+    UmrfGraph& ugh = named_umrf_graphs_.at(graph_name);
+
+    /*
+     * Before modyfing the graph, check if the graph contains the UMRFs which are menitoned in the diffs
+     */ 
+    for (const auto& graph_diff : graph_diffs)
     {
-      if (ugh.partOfGraph(graph_diff.umrf.getFullName()))
+      if (graph_diff.operation == UmrfGraphDiff::Operation::add_umrf)
       {
-        throw CREATE_TEMOTO_ERROR_STACK("Cannot add UMRF '" + graph_diff.umrf.getFullName()
-          + "', as it is already part of graph '" + graph_name + "'");
+        if (ugh.partOfGraph(graph_diff.umrf.getFullNameAtom()))
+        {
+          throw CREATE_TEMOTO_ERROR_STACK("Cannot add UMRF '" + graph_diff.umrf.getFullName()
+            + "', as it is already part of graph '" + graph_name + "'");
+        }
+      }
+      else
+      {
+        if (!ugh.partOfGraph(graph_diff.umrf.getFullNameAtom()))
+        {
+          throw CREATE_TEMOTO_ERROR_STACK("Cannot perform operation '" + graph_diff.operation
+          + "' because UMRF graph '" + graph_name + "' does not contain node named '"
+          + graph_diff.umrf.getFullName() + "'");
+        }
       }
     }
-    else
+
+    /*
+     * Apply the diffs
+     */ 
+    for (const auto& graph_diff : graph_diffs)
     {
-      if (!ugh.partOfGraph(graph_diff.umrf.getFullName()))
+      if (graph_diff.operation == UmrfGraphDiff::Operation::add_umrf)
+      {
+        TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
+        Umrf umrf_cpy = graph_diff.umrf;
+        umrf_cpy.setId(createId());
+        ugh.addUmrf(umrf_cpy);
+        action_graph_index_.emplace(umrf_cpy.getId(), graph_name);
+      }
+      else if (graph_diff.operation == UmrfGraphDiff::Operation::remove_umrf)
+      {
+        TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
+        unsigned int action_handle_id = ugh.removeUmrf(graph_diff.umrf);
+        action_graph_index_.erase(action_handle_id);
+        eraseActionHandle(action_handle_id, erased_action_handles);
+        named_action_handles_.release(action_handle_id);
+      }
+      else if (graph_diff.operation == UmrfGraphDiff::Operation::add_child)
+      {
+        TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
+        ugh.addChild(graph_diff.umrf);
+      }
+      else if (graph_diff.operation == UmrfGraphDiff::Operation::remove_child)
       {
-        throw CREATE_TEMOTO_ERROR_STACK("Cannot perform operation '" + graph_diff.operation
-        + "' because UMRF graph '" + graph_name + "' does not contain node named '"
-        + graph_diff.umrf.getFullName() + "'");
+        TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
+        ugh.removeChild(graph_diff.umrf);
       }
+      else
+      {
+        throw CREATE_TEMOTO_ERROR_STACK("No such operation as " + graph_diff.operation);
+      }
+      TEMOTO_PRINT("Finished with the '" + graph_diff.operation + "' operation.");
     }
   }
-
-  /*
-   * Apply the diffs
-   */ 
-  for (const auto& graph_diff : graph_diffs)
+  catch(TemotoErrorStack e)
   {
-    if (graph_diff.operation == UmrfGraphDiff::Operation::add_umrf)
-    {
-      TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
-      Umrf umrf_cpy = graph_diff.umrf;
-      umrf_cpy.setId(createId());
-      ugh.addUmrf(umrf_cpy);
-    }
-    else if (graph_diff.operation == UmrfGraphDiff::Operation::remove_umrf)
-    {
-      TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
-      unsigned int action_handle_id = ugh.removeUmrf(graph_diff.umrf);
-      stopAction(action_handle_id);
-    }
-    else if (graph_diff.operation == UmrfGraphDiff::Operation::add_child)
-    {
-      TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
-      ugh.addChild(graph_diff.umrf);
-    }
-    else if (graph_diff.operation == UmrfGraphDiff::Operation::remove_child)
-    {
-      TEMOTO_PRINT("Applying an '" + graph_diff.operation + "' operation to UMRF '" + graph_diff.umrf.getFullName() + "' ...");
-      ugh.removeChild(graph_diff.umrf);
-    }
-    else
-    {
-      throw CREATE_TEMOTO_ERROR_STACK("No such operation as " + graph_diff.operation);
-    }
-    TEMOTO_PRINT("Finished with the '" + graph_diff.operation + "' operation.");
+    clearActionHandles(erased_action_handles);
+    throw FORWARD_TEMOTO_ERROR_STACK(e);
   }
+  clearActionHandles(erased_action_handles);
 }
 
 void ActionExecutor::executeUmrfGraph(const std::string& graph_name)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
   try
   {
-    // Check if the requested graph exists
-    if (!graphExists(graph_name))
+    std::vector<unsigned int> action_ids;
     {
-      throw CREATE_TEMOTO_ERROR_STACK("Cannot execute UMRF graph '" + graph_name + "' because it doesn't exist.");
-    }
+      SHARED_LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
 
-    // Check if the graph is in initialized state
-    /*
-     * TODO: Also check if the graph is in running state and could it be updated
-     * i.e., does any of its actions are accepting parameters that can be updated (pvf_updatable = true)
-     */
-    if (named_umrf_graphs_.at(graph_name).checkState() != UmrfGraph::State::INITIALIZED)
-    {
-      throw CREATE_TEMOTO_ERROR_STACK("Cannot execute UMRF graph '" + graph_name + "' because it's not in initialized state.");
+      // Check if the requested graph exists
+      auto nug_it = named_umrf_graphs_.find(graph_name);
+      if (nug_it == named_umrf_graphs_.end())
+      {
+        throw CREATE_TEMOTO_ERROR_STACK("Cannot execute UMRF graph '" + graph_name + "' because it doesn't exist.");
+      }
+
+      // Check if the graph is in initialized state
+      /*
+       * TODO: Also check if the graph is in running state and could it be updated
+       * i.e., does any of its actions are accepting parameters that can be updated (pvf_updatable = true)
+       */
+      if (nug_it->second.checkState() != UmrfGraph::State::INITIALIZED)
+      {
+        throw CREATE_TEMOTO_ERROR_STACK("Cannot execute UMRF graph '" + graph_name + "' because it's not in initialized state.");
+      }
+
+      const UmrfGraph& ugh = nug_it->second;
+      action_ids = ugh.getRootNodes();
+      for (const auto& action_id : action_ids)
+      {
+        if (!ugh.getUmrfOf(action_id).inputParametersReceived())
+        {
+          throw CREATE_TEMOTO_ERROR_STACK("Cannot execute UMRF graph '" + graph_name + "' because action '"
+            + ugh.getUmrfOf(action_id).getFullName() + "' has not received all required input parameters.");
+        }
+      }
     }
 
-    UmrfGraph& ugh = named_umrf_graphs_.at(graph_name);
-    std::vector<unsigned int> action_ids = ugh.getRootNodes();
-    executeById(action_ids, ugh, true);
+    // The actions are loaded without holding the executor locks
+    executeById(action_ids, graph_name, true);
   }
   catch(TemotoErrorStack e)
   {
@@ -457,46 +606,83 @@ void ActionExecutor::executeUmrfGraph(const std::string& graph_name)
 
 void ActionExecutor::stopUmrfGraph(const std::string& graph_name)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
-
-  // Check if the requested graph exists
-  if (named_umrf_graphs_.find(graph_name) == named_umrf_graphs_.end())
+  /*
+   * Request all actions of the graph to stop first, so that they can stop concurrently. The locks are
+   * not held while waiting, because the stopping actions may need them to report their completion
+   */
+  std::vector<std::shared_ptr<ActionHandle>> stopped_action_handles;
   {
-    throw CREATE_TEMOTO_ERROR_STACK("Cannot stop UMRF graph '" + graph_name + "' because it doesn't exist.");
+    SHARED_LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    SHARED_LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+
+    // Check if the requested graph exists
+    auto nug_it = named_umrf_graphs_.find(graph_name);
+    if (nug_it == named_umrf_graphs_.end())
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Cannot stop UMRF graph '" + graph_name + "' because it doesn't exist.");
+    }
+
+    for (const auto& action_id : nug_it->second.getNodeIds())
+    {
+      std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(action_id);
+      if (handle_slot != nullptr && *handle_slot && (*handle_slot)->requestStop())
+      {
+        stopped_action_handles.push_back(*handle_slot);
+      }
+    }
   }
 
-  for (const auto& umrf : named_umrf_graphs_.at(graph_name).getUmrfs())
+  // Wait for the actions against a common deadline. The graph is removed even if some actions fail to stop
+  std::vector<TemotoErrorStack> stop_errors;
+  const auto stop_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  for (const auto& action_handle : stopped_action_handles)
   {
     try
     {
-      stopAction(umrf.getId());
+      action_handle->waitForStop(stop_deadline);
     }
     catch (TemotoErrorStack e)
     {
-      throw FORWARD_TEMOTO_ERROR_STACK(e);
+      stop_errors.push_back(e);
     }
-    catch (std::exception& e)
+  }
+
+  // The handles are detached from the executor under the locks and cleared after the locks are released
+  std::vector<std::shared_ptr<ActionHandle>> erased_action_handles;
+  {
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+
+    // The graph might have been removed by another thread in the meantime
+    auto nug_it = named_umrf_graphs_.find(graph_name);
+    if (nug_it != named_umrf_graphs_.end())
     {
-      throw CREATE_TEMOTO_ERROR_STACK(e.what());
+      eraseUmrfGraph(nug_it, erased_action_handles);
     }
   }
-  named_umrf_graphs_.erase(graph_name);
+  clearActionHandles(erased_action_handles);
+
+  if (!stop_errors.empty())
+  {
+    throw FORWARD_TEMOTO_ERROR_STACK(stop_errors.front());
+  }
 }
 
 void ActionExecutor::stopAction(unsigned int action_handle_id)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-
-  auto action_handle_it = named_action_handles_.find(action_handle_id);
-  if (action_handle_it == named_action_handles_.end())
+  // The handle is detached under the lock and stopped after the lock is released
+  std::vector<std::shared_ptr<ActionHandle>> erased_action_handles;
   {
-    return;
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    eraseActionHandle(action_handle_id, erased_action_handles);
   }
+
   try
   {
-    action_handle_it->second.clearAction();
-    named_action_handles_.erase(action_handle_it);
+    for (auto& action_handle : erased_action_handles)
+    {
+      action_handle->clearAction();
+    }
   }
   catch (TemotoErrorStack e)
   {
@@ -508,105 +694,249 @@ void ActionExecutor::stopAction(unsigned int action_handle_id)
   }
 }
 
-void ActionExecutor::executeById(const std::vector<unsigned int> ids, UmrfGraph& ugh, bool initialized_requrired)
+void ActionExecutor::eraseActionHandle(const unsigned int& action_handle_id, std::vector<std::shared_ptr<ActionHandle>>& erased_action_handles)
 {
-  LOCK_GUARD_TYPE_R guard_handles(named_action_handles_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_graphs(named_umrf_graphs_rw_mutex_);
+  std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(action_handle_id);
+  if (handle_slot == nullptr || !(*handle_slot))
+  {
+    return;
+  }
+  erased_action_handles.push_back(std::move(*handle_slot));
+}
 
-  std::set<unsigned int> action_rollback_list;
-  std::set<unsigned int> init_action_ids;
-  try
+void ActionExecutor::executeById(const std::vector<unsigned int>& ids, const std::string& graph_name, bool initialized_requrired)
+{
+  /*
+   * Get the UMRFs of the actions. The graph is locked only for the time of copying
+   */
+  std::vector<Umrf> umrfs;
   {
-    /*
-     * Load the action handles
-     */ 
-    HandleMap named_action_handles_tmp;
+    SHARED_LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+    auto nug_it = named_umrf_graphs_.find(graph_name);
+    if (nug_it == named_umrf_graphs_.end())
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Cannot execute the actions because UMRF graph '" + graph_name + "' does not exist.");
+    }
     for (const auto& action_id : ids)
     {
-      ActionHandle ah = ActionHandle(ugh.getUmrfOf(action_id), this);
-      if (ah.getState() != ActionHandle::State::INITIALIZED)
+      umrfs.push_back(nug_it->second.getUmrfOf(action_id));
+    }
+  }
+
+  /*
+   * Prepare phase: load the action libraries and instantiate the actions. This is the slow part, hence
+   * it's done without holding the executor locks. Nothing is published before all actions are instantiated
+   */
+  std::vector<std::shared_ptr<ActionHandle>> action_handles;
+  std::vector<unsigned int> failed_action_ids;
+  try
+  {
+    for (auto& umrf : umrfs)
+    {
+      std::shared_ptr<ActionHandle> ah = std::make_shared<ActionHandle>(std::move(umrf), this);
+      if (ah->getState() != ActionHandle::State::INITIALIZED)
       {
         if (initialized_requrired)
         {
           throw CREATE_TEMOTO_ERROR_STACK("Cannot execute the actions because all actions were not fully initialized.");
         }
+
+        // The handle checks only the UMRF and the action library, hence the node has failed for good
+        TEMOTO_PRINT("Action '" + ah->getActionName() + "' could not be initialized.");
+        failed_action_ids.push_back(ah->getHandleId());
+        continue;
       }
-      else
-      {
-        named_action_handles_tmp.insert(std::pair<unsigned int, ActionHandle>(ah.getHandleId(), ah));
-        init_action_ids.insert(ah.getHandleId());
-        action_rollback_list.insert(ah.getHandleId());
-      }
+      ah->instantiateAction();
+      action_handles.push_back(std::move(ah));
     }
+  }
+  catch(TemotoErrorStack e)
+  {
+    // None of the actions is started, hence all of them have failed. Otherwise the graph would wait for them forever
+    clearActionHandles(action_handles);
+    setGraphNodesError(graph_name, ids);
+    throw FORWARD_TEMOTO_ERROR_STACK(e);
+  }
+  catch(const std::exception& e)
+  {
+    clearActionHandles(action_handles);
+    setGraphNodesError(graph_name, ids);
+    throw CREATE_TEMOTO_ERROR_STACK("Cannot initialize the actions because: " 
+      + std::string(e.what()));
+  }
 
-    // put all loaded action handles to the global named_action_handles map
-    named_action_handles_.insert(named_action_handles_tmp.begin(), named_action_handles_tmp.end());
+  // The failed actions are terminal nodes of the graph, otherwise the graph would wait for them forever
+  if (!failed_action_ids.empty())
+  {
+    setGraphNodesError(graph_name, failed_action_ids);
+  }
 
-    /*
-     * Load/Instantiate the actions. If there are any problems with instantiating
-     * the graph, then the whole graph is rolled back (uninitialized)
-     */
-    for (const auto& action_id : init_action_ids)
+  /*
+   * Commit phase: publish the action handles and start the actions. If there are any problems with
+   * executing the actions, then the started actions are rolled back
+   */
+  std::vector<std::shared_ptr<ActionHandle>> rolled_back_action_handles;
+  try
+  {
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+
+    // The graph might have been stopped while the actions were prepared
+    auto nug_it = named_umrf_graphs_.find(graph_name);
+    if (nug_it == named_umrf_graphs_.end())
     {
-      // Instantiate the action
-      try
+      return;
+    }
+    UmrfGraph& ugh = nug_it->second;
+
+    std::vector<unsigned int> action_rollback_list;
+    try
+    {
+      for (auto& ah : action_handles)
       {
-        named_action_handles_.at(action_id).instantiateAction();
-        action_rollback_list.insert(action_id);
+        const unsigned int action_id = ah->getHandleId();
+
+        // The action might have been removed from the graph or started by another thread in the meantime
+        if (!ugh.partOfGraph(action_id))
+        {
+          continue;
+        }
+        std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(action_id);
+        if (handle_slot == nullptr)
+        {
+          continue;
+        }
+        if (*handle_slot)
+        {
+          const ActionHandle::State existing_state = (*handle_slot)->getState();
+          if (existing_state == ActionHandle::State::READY ||
+              existing_state == ActionHandle::State::RUNNING ||
+              existing_state == ActionHandle::State::STOP_REQUESTED)
+          {
+            continue;
+          }
+        }
+
+        // Execute the action
+        try
+        {
+          *handle_slot = std::move(ah);
+          action_rollback_list.push_back(action_id);
+          (*handle_slot)->executeActionThread(thread_pool_);
+          ugh.setNodeActive(action_id);
+        }
+        catch(TemotoErrorStack e)
+        {
+          ugh.setNodeError(action_id);
+          throw FORWARD_TEMOTO_ERROR_STACK(e);
+        } 
+        catch(const std::exception& e)
+        {
+          ugh.setNodeError(action_id);
+          throw CREATE_TEMOTO_ERROR_STACK("Cannot execute the actions because: " 
+            + std::string(e.what()));
+        }
       }
-      catch(TemotoErrorStack e)
-      {
-        ugh.setNodeError(action_id);
-        throw FORWARD_TEMOTO_ERROR_STACK(e);
-      } 
-      catch(const std::exception& e)
+    }
+    catch(TemotoErrorStack e)
+    {
+      std::cout << "Rollbacking actions" << std::endl;
+      for (const auto& action_id : action_rollback_list)
       {
-        ugh.setNodeError(action_id);
-        throw CREATE_TEMOTO_ERROR_STACK("Cannot initialize the actions because: " 
-          + std::string(e.what()));
+        eraseActionHandle(action_id, rolled_back_action_handles);
+        ugh.setNodeFinished(action_id);
       }
+      throw FORWARD_TEMOTO_ERROR_STACK(e);
     }
+  }
+  catch(TemotoErrorStack e)
+  {
+    // The rolled back actions are stopped after the locks are released
+    clearActionHandles(rolled_back_action_handles);
+    throw FORWARD_TEMOTO_ERROR_STACK(e);
+  }
+}
 
-    /*
-     * Execute the actions. If there are any problems with executing
-     * the graph, then the whole graph is rolled back
-     */
-    for (const auto& action_id : init_action_ids)
+void ActionExecutor::setGraphNodesError(const std::string& graph_name, const std::vector<unsigned int>& action_ids)
+{
+  std::vector<std::shared_ptr<ActionHandle>> erased_action_handles;
+  {
+    LOCK_GUARD_TYPE_RW guard_handles(named_action_handles_rw_mutex_);
+    LOCK_GUARD_TYPE_RW guard_graphs(named_umrf_graphs_rw_mutex_);
+    auto nug_it = named_umrf_graphs_.find(graph_name);
+    if (nug_it == named_umrf_graphs_.end())
     {
-      // Execute the action
-      try
-      {
-        named_action_handles_.at(action_id).executeActionThread();
-        action_rollback_list.insert(action_id);
-        ugh.setNodeActive(action_id);
-      }
-      catch(TemotoErrorStack e)
-      {
-        ugh.setNodeError(action_id);
-        throw FORWARD_TEMOTO_ERROR_STACK(e);
-      } 
-      catch(const std::exception& e)
+      return;
+    }
+    for (const auto& action_id : action_ids)
+    {
+      // Skip the actions that were started by another thread in the meantime
+      std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(action_id);
+      if (handle_slot != nullptr && *handle_slot)
       {
-        ugh.setNodeError(action_id);
-        throw CREATE_TEMOTO_ERROR_STACK("Cannot execute the actions because: " 
-          + std::string(e.what()));
+        const ActionHandle::State existing_state = (*handle_slot)->getState();
+        if (existing_state == ActionHandle::State::READY ||
+            existing_state == ActionHandle::State::RUNNING ||
+            existing_state == ActionHandle::State::STOP_REQUESTED)
+        {
+          continue;
+        }
       }
+      nug_it->second.setNodeError(action_id);
+    }
+
+    // Same as in cleanupAction, a failed graph is removed once none of its nodes is active
+    if (nug_it->second.checkState() == UmrfGraph::State::ERROR && !nug_it->second.hasActiveNodes())
+    {
+      TEMOTO_PRINT("Graph '" + graph_name + "' has failed.");
+      eraseUmrfGraph(nug_it, erased_action_handles);
     }
   }
-  catch(TemotoErrorStack e)
+  clearActionHandles(erased_action_handles);
+}
+
+ActionExecutor::UmrfGraphMap::iterator ActionExecutor::findGraphOf(const unsigned int& action_id)
+{
+  auto agi_it = action_graph_index_.find(action_id);
+  if (agi_it == action_graph_index_.end())
+  {
+    return named_umrf_graphs_.end();
+  }
+  return named_umrf_graphs_.find(agi_it->second);
+}
+
+void ActionExecutor::eraseUmrfGraph(UmrfGraphMap::iterator graph_it, std::vector<std::shared_ptr<ActionHandle>>& erased_action_handles)
+{
+  for (const auto& node_id : graph_it->second.getNodeIds())
   {
-    std::cout << "Rollbacking actions" << std::endl;
-    for (const auto& action_id : action_rollback_list)
+    action_graph_index_.erase(node_id);
+    std::shared_ptr<ActionHandle>* handle_slot = named_action_handles_.find(node_id);
+    if (handle_slot != nullptr && *handle_slot)
     {
-      named_action_handles_.at(action_id).clearAction();
-      named_action_handles_.erase(action_id);
-      ugh.setNodeFinished(action_id);
+      erased_action_handles.push_back(std::move(*handle_slot));
+    }
+    named_action_handles_.release(node_id);
+  }
+  named_umrf_graphs_.erase(graph_it);
+}
+
+void ActionExecutor::clearActionHandles(std::vector<std::shared_ptr<ActionHandle>>& action_handles)
+{
+  for (auto& action_handle : action_handles)
+  {
+    try
+    {
+      action_handle->clearAction();
+    }
+    catch(TemotoErrorStack e)
+    {
+      std::cout << e.what() << '\n';
     }
-    throw FORWARD_TEMOTO_ERROR_STACK(e);
   }
+  action_handles.clear();
 }
 
 unsigned int ActionExecutor::createId()
 {
-  return action_handle_id_count_++;
+  return named_action_handles_.allocate();
 }
\ No newline at end of file
@@ -18,15 +18,14 @@
 
 #include "temoto_action_engine/action_handle.h"
 #include "temoto_action_engine/action_executor.h"
-#include "temoto_action_engine/basic_timer.h"
 #include "temoto_action_engine/action_base.h"
 #include "temoto_action_engine/messaging.h"
 
 ActionHandle::ActionHandle(Umrf umrf, ActionExecutor* action_executor_ptr)
-: state_(ActionHandle::State::UNINITIALIZED)
-, action_executor_ptr_(action_executor_ptr)
-, umrf_(std::make_shared<Umrf>(umrf))
+: action_executor_ptr_(action_executor_ptr)
+, state_(ActionHandle::State::UNINITIALIZED)
 , future_retreived_(false)
+, umrf_(std::make_shared<Umrf>(std::move(umrf)))
 {
   /*
    * TODO: If the library does not exist, then handle the situation accordingly
@@ -47,31 +46,20 @@ ActionHandle::ActionHandle(Umrf umrf, ActionExecutor* action_executor_ptr)
 
   try
   {
-    LOCK_GUARD_TYPE guard_class_loader(class_loader_rw_mutex_);
-    class_loader_ = std::make_shared<class_loader::ClassLoader>(umrf.getLibraryPath(), false);
+    LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+    ActionLibraryCache& library_cache = action_executor_ptr_->getLibraryCache();
+    class_loader_ = library_cache.getClassLoader(umrf_->getLibraryPath());
 
     // Check if the classloader actually contains the required action
-    std::vector<std::string> classes_in_classloader = class_loader_->getAvailableClasses<ActionBase>();
-    bool class_found = false;
-    for (const auto& class_in_classloader : classes_in_classloader)
-    {
-      if (class_in_classloader == umrf_->getName())
-      {
-        class_found = true;
-        break;
-      }
-    }
-
-    if (!class_found)
+    if (!library_cache.containsClass(umrf_->getLibraryPath(), umrf_->getName()))
     {
       TEMOTO_PRINT("Failed to initialize the Action Handle because the action class name is incorrect");
       setState(ActionHandle::State::ERROR);
       return;
     }
-    if (umrf_->inputParametersReceived() && umrf_->requiredParentsFinished())
-    {
-      setState(ActionHandle::State::INITIALIZED);
-    }
+
+    // The readiness of the action (parents finished, inputs received) is resolved by the executor
+    setState(ActionHandle::State::INITIALIZED);
   }
   catch(const std::exception& e)
   {
@@ -79,43 +67,93 @@ ActionHandle::ActionHandle(Umrf umrf, ActionExecutor* action_executor_ptr)
   }
 }
 
-ActionHandle::ActionHandle(const ActionHandle& ah)
-: action_executor_ptr_(ah.action_executor_ptr_)
-, state_(ah.state_)
-, action_future_(ah.action_future_)
-, class_loader_(ah.class_loader_)
-, umrf_(ah.umrf_)
-, action_instance_(ah.action_instance_)
-, future_retreived_(ah.future_retreived_)
-{}
-
-const ActionHandle::State& ActionHandle::getState() const
+const char* ActionHandle::stateToStr(ActionHandle::State state)
 {
-  LOCK_GUARD_TYPE guard_state(state_rw_mutex_);
-  return state_;
+  static const char* const state_names[] =
+  {
+    "UNINITIALIZED",
+    "INITIALIZED",
+    "READY",
+    "RUNNING",
+    "STOP_REQUESTED",
+    "FINISHED",
+    "ERROR"
+  };
+  const unsigned int state_index = static_cast<unsigned int>(state);
+  return (state_index < sizeof(state_names) / sizeof(state_names[0])) ? state_names[state_index] : "UNKNOWN";
+}
+
+ActionHandle::State ActionHandle::getState() const
+{
+  return state_.load();
 }
 
 bool ActionHandle::setState(ActionHandle::State state_to_set)
 {
-  LOCK_GUARD_TYPE guard_state(state_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
-  if(state_ == state_to_set)
+  State current_state = state_.load();
+  do
+  {
+    if (current_state == state_to_set || !isLegalTransition(current_state, state_to_set))
+    {
+      return false;
+    }
+  } while (!state_.compare_exchange_weak(current_state, state_to_set));
+
+  // TEMOTO_PRINT_OF("Changing state from " + std::string(stateToStr(current_state)) + " to " + stateToStr(state_to_set)
+  //                , umrf_->getFullName());
+  if (action_executor_ptr_ != nullptr)
+  {
+    action_executor_ptr_->notifyStateChange(current_state, state_to_set);
+  }
+  return true;
+}
+
+bool ActionHandle::setState(ActionHandle::State expected_state, ActionHandle::State state_to_set)
+{
+  if (expected_state == state_to_set || !isLegalTransition(expected_state, state_to_set))
   {
     return false;
   }
-  else
+  if (!state_.compare_exchange_strong(expected_state, state_to_set))
   {
-    // TEMOTO_PRINT_OF("Changing state from " + state_to_str_map_[state_] + " to " + state_to_str_map_[state_to_set]
-    //                , umrf_->getFullName());
-    state_ = state_to_set;
-    return true; 
+    return false;
+  }
+  if (action_executor_ptr_ != nullptr)
+  {
+    action_executor_ptr_->notifyStateChange(expected_state, state_to_set);
+  }
+  return true;
+}
+
+bool ActionHandle::isLegalTransition(ActionHandle::State from, ActionHandle::State to)
+{
+  if (to == State::ERROR)
+  {
+    return true;
+  }
+  switch (from)
+  {
+    case State::UNINITIALIZED:
+      return to == State::INITIALIZED;
+    case State::INITIALIZED:
+      return to == State::READY;
+    case State::READY:
+      return to == State::RUNNING || to == State::INITIALIZED;
+    case State::RUNNING:
+      return to == State::STOP_REQUESTED || to == State::FINISHED;
+    case State::STOP_REQUESTED:
+      return to == State::FINISHED;
+    case State::FINISHED:
+    case State::ERROR:
+      return to == State::INITIALIZED;
+    default:
+      return false;
   }
 }
 
 void ActionHandle::instantiateAction()
 { 
-  LOCK_GUARD_TYPE guard_action_instance(action_instance_rw_mutex_);
-  LOCK_GUARD_TYPE guard_class_loader(class_loader_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
 
   if (getState() != ActionHandle::State::INITIALIZED)
   {
@@ -124,7 +162,6 @@ void ActionHandle::instantiateAction()
 
   try
   {
-    LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
     action_instance_ = class_loader_->createInstance<ActionBase>(umrf_->getName());
     action_instance_->setUmrf(umrf_);
     setState(ActionHandle::State::READY);
@@ -140,37 +177,39 @@ TemotoErrorStack ActionHandle::executeAction()
 {
   // TODO: If the action will block, and the action instance is guarded
   // with a mutex at the same time, then the action cannot be stopped
-  //LOCK_GUARD_TYPE guard_action_instance(action_instance_rw_mutex_);
+  //LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   
-  if (getState() != ActionHandle::State::READY)
+  if (!setState(ActionHandle::State::READY, ActionHandle::State::RUNNING))
   {
     return CREATE_TEMOTO_ERROR_STACK("Cannot execute the action because it's not in READY state");
   }
   try
   {
-    setState(ActionHandle::State::RUNNING);
-    future_retreived_ = false;
-    action_instance_->executeActionWrapped(); // Blocking call, returns when finished
+    boost::shared_ptr<ActionBase> action_instance;
+    {
+      LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+      future_retreived_ = false;
+      action_instance = action_instance_;
+    }
+    action_instance->executeActionWrapped(); // Blocking call, returns when finished
 
     if ((getState() == ActionHandle::State::RUNNING))
     {
-      LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
-      action_executor_ptr_->notifyFinished(
-        umrf_->getId()
-      , umrf_->getOutputParameters());
-
-      /*
-       * TODO: if the parameters are not cleared over here, then action handle cleanup might crash
-       * in case the parameters are shared. This could be attributed to how boost::any works but at
-       * this point I am clueless why the crash happens. If the parameters are cleared in the 
-       * destructor of the ActionHandle, then the crashing behavior still remains. It seems as if
-       * the data which the parameter is "pointing" to is magically invalid and leads to a crash.
-       * 
-       * PS: this means that as long as this particular TODO exists, pointers should not be passed
-       *     between actions!
-       */ 
-      umrf_->getOutputParametersNc().clear();
-      //umrf_->getInputParametersNc().clear();
+      // The UMRF is not locked while notifying the executor, as it might load the children of this action
+      unsigned int umrf_id;
+      ActionParameters output_parameters;
+      {
+        /*
+         * The output data might be created by the code of the action library, so the data keeps the library
+         * loaded for as long as it exists, i.e., the outputs can outlive this action handle. The data is shared
+         * with the children of this action, not copied.
+         */
+        LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+        umrf_id = umrf_->getId();
+        umrf_->getOutputParametersNc().pinPayloads(class_loader_);
+        output_parameters = umrf_->getOutputParameters();
+      }
+      action_executor_ptr_->notifyFinished(umrf_id, output_parameters);
     }
     setState(ActionHandle::State::FINISHED);
 
@@ -195,16 +234,31 @@ TemotoErrorStack ActionHandle::executeAction()
   }
 }
 
-void ActionHandle::executeActionThread()
+void ActionHandle::executeActionThread(ThreadPool& thread_pool)
 {
-  LOCK_GUARD_TYPE_R guard_action_future(action_future_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   if (getState() != ActionHandle::State::READY)
   {
     throw CREATE_TEMOTO_ERROR_STACK("Cannot execute the action because it's not in READY state");
   }
   try
   {
-    action_future_ = std::make_shared<std::future<TemotoErrorStack>>(std::async( std::launch::async, &ActionHandle::executeAction, this));
+    /*
+     * The task is stored in the shared state of action_future_, hence it holds only a weak reference
+     * to the handle. Otherwise the handle and its future would keep each other alive
+     */
+    std::weak_ptr<ActionHandle> weak_self = shared_from_this();
+    action_future_ = thread_pool.submit([weak_self]
+    {
+      std::shared_ptr<ActionHandle> self = weak_self.lock();
+      if (!self)
+      {
+        return CREATE_TEMOTO_ERROR_STACK("The action was not executed because its handle was destroyed.");
+      }
+      TemotoErrorStack error_stack = self->executeAction();
+      self->action_executor_ptr_->notifyCompleted(self);
+      return error_stack;
+    }).share();
   }
   catch(const std::exception& e)
   {
@@ -215,25 +269,37 @@ void ActionHandle::executeActionThread()
 
 void ActionHandle::stopAction(double timeout)
 {
-  LOCK_GUARD_TYPE guard_action_instance(action_instance_rw_mutex_);
-  if (getState() == ActionHandle::State::RUNNING)
+  requestStop();
+  waitForStop(std::chrono::steady_clock::now()
+    + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout)));
+}
+
+bool ActionHandle::requestStop()
+{
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+  if (!setState(ActionHandle::State::RUNNING, ActionHandle::State::STOP_REQUESTED))
   {
-    setState(ActionHandle::State::STOP_REQUESTED);
-    action_instance_->stopAction();
+    return false;
+  }
+  action_instance_->stopAction();
+  return true;
+}
 
-    // Wait until the action is finished
-    Timer timeout_timer;
-    while(!futureIsReady())
-    {
-      if (timeout_timer.elapsed() >= timeout)
-      {
-        setState(ActionHandle::State::ERROR);
-        throw CREATE_TEMOTO_ERROR_STACK("Reached the timeout of " + std::to_string(timeout) + " seconds.");
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    setState(ActionHandle::State::FINISHED);
+void ActionHandle::waitForStop(const std::chrono::steady_clock::time_point& deadline)
+{
+  if (getState() != ActionHandle::State::STOP_REQUESTED)
+  {
+    return;
   }
+
+  // Wait until the action thread has returned
+  std::shared_future<TemotoErrorStack> action_future = getFuture();
+  if (action_future.valid() && action_future.wait_until(deadline) != std::future_status::ready)
+  {
+    setState(ActionHandle::State::ERROR);
+    throw CREATE_TEMOTO_ERROR_STACK("Action '" + getActionName() + "' did not stop before the deadline.");
+  }
+  setState(ActionHandle::State::FINISHED);
 }
 
 void ActionHandle::clearAction()
@@ -241,10 +307,9 @@ void ActionHandle::clearAction()
   try
   {
     stopAction(10);
-    LOCK_GUARD_TYPE guard_action_instance(action_instance_rw_mutex_);
-    LOCK_GUARD_TYPE_R guard_action_future(action_future_rw_mutex_);
+    LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
     action_instance_.reset();
-    action_future_.reset();
+    action_future_ = std::shared_future<TemotoErrorStack>();
     setState(ActionHandle::State::INITIALIZED);
   }
   catch(TemotoErrorStack e)
@@ -261,12 +326,18 @@ void ActionHandle::clearAction()
   }
 }
 
+std::shared_future<TemotoErrorStack> ActionHandle::getFuture() const
+{
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+  return action_future_;
+}
+
 bool ActionHandle::futureIsReady()
 {
-  LOCK_GUARD_TYPE_R guard_action_future(action_future_rw_mutex_);
-  if (action_future_.use_count() > 0)
+  std::shared_future<TemotoErrorStack> action_future = getFuture();
+  if (action_future.valid())
   {
-    return action_future_->wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    return action_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
   }
   else
   {
@@ -274,9 +345,22 @@ bool ActionHandle::futureIsReady()
   }
 }
 
+void ActionHandle::waitForFuture()
+{
+  std::shared_future<TemotoErrorStack> action_future = getFuture();
+  if (action_future.valid())
+  {
+    action_future.wait();
+  }
+}
+
 TemotoErrorStack ActionHandle::getFutureValue()
 {
-  LOCK_GUARD_TYPE_R guard_action_future(action_future_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+  if (!action_future_.valid())
+  {
+    throw CREATE_TEMOTO_ERROR_STACK("Tried to retrieve future value of an action that was not executed.");
+  }
   if (!futureIsReady())
   {
     throw CREATE_TEMOTO_ERROR_STACK("Tried to retrieve future value before it's ready.");
@@ -286,16 +370,15 @@ TemotoErrorStack ActionHandle::getFutureValue()
     throw CREATE_TEMOTO_ERROR_STACK("Future value is already retreived.");
   }
   future_retreived_ = true;
-  return action_future_->get();
+  return action_future_.get();
 }
 
 bool ActionHandle::clearFuture()
 {
-  LOCK_GUARD_TYPE_R guard_action_future(action_future_rw_mutex_);
-  LOCK_GUARD_TYPE guard_action_state(state_rw_mutex_);
-  if (state_ != State::RUNNING)
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
+  if (getState() != State::RUNNING)
   {
-    action_future_.reset();
+    action_future_ = std::shared_future<TemotoErrorStack>();
     return true;
   }
   return false;
@@ -303,25 +386,25 @@ bool ActionHandle::clearFuture()
 
 const std::string& ActionHandle::getEffect() const
 {
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   return umrf_->getEffect();
 }
 
 const std::string& ActionHandle::getActionName() const
 {
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   return umrf_->getFullName();
 }
 
 const unsigned int& ActionHandle::getHandleId() const
 {
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   return umrf_->getId();
 }
 
 bool ActionHandle::addInputParameters(ActionParameters action_parameters)
 {
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   bool ret_val = umrf_->copyInputParameters(action_parameters);
 
   if (umrf_->inputParametersReceived())
@@ -333,7 +416,7 @@ bool ActionHandle::addInputParameters(ActionParameters action_parameters)
 
 void ActionHandle::updateUmrf(const Umrf& umrf_in)
 {
-  LOCK_GUARD_TYPE_R guard_umrf(umrf_rw_mutex_);
+  LOCK_GUARD_TYPE_R guard_handle(handle_rw_mutex_);
   try
   {
     // Don't update the action if it is in error or stop request state
@@ -20,11 +20,14 @@
 #include "temoto_action_engine/messaging.h"
 #include "temoto_action_engine/temoto_error.h"
 #include "temoto_action_engine/umrf_json_converter.h"
+#include "temoto_action_engine/action_base.h"
+#include <class_loader/class_loader.hpp>
 #include <algorithm>
 #include <sstream>
 #include <fstream>
 
-ActionIndexer::ActionIndexer()
+ActionIndexer::ActionIndexer(bool probe_libraries)
+: probe_libraries_(probe_libraries)
 {}
 
 void ActionIndexer::addActionPath(const std::string& path)
@@ -57,6 +60,7 @@ void ActionIndexer::indexActions()
   {
     // Clear the old indexed umrfs frames
     indexed_umrfs_.clear();
+    library_manifests_.clear();
 
     for (const std::string action_path : action_paths_)
     {
@@ -110,6 +114,12 @@ void ActionIndexer::findActionFilesys( std::string action_to_find
           std::string action_lib_path = hackdir.parent_path().string() + "/lib/lib" + umrf.getPackageName() + ".so";
           umrf.setLibraryPath(action_lib_path);
           //std::cout << umrf << std::endl;
+          if (probe_libraries_ && !libraryContainsAction(umrf))
+          {
+            TEMOTO_PRINT("Skipping action '" + umrf.getName() + "' because library '" + action_lib_path
+              + "' does not contain it.");
+            continue;
+          }
           indexed_umrfs_.push_back(umrf);
         }
 
@@ -134,9 +144,40 @@ void ActionIndexer::findActionFilesys( std::string action_to_find
   }
 }
 
+bool ActionIndexer::libraryContainsAction(const Umrf& umrf)
+{
+  auto manifest_it = library_manifests_.find(umrf.getLibraryPath());
+  if (manifest_it == library_manifests_.end())
+  {
+    std::vector<std::string> class_names;
+    if (boost::filesystem::exists(umrf.getLibraryPath()))
+    {
+      try
+      {
+        class_loader::ClassLoader class_loader(umrf.getLibraryPath(), false);
+        class_names = class_loader.getAvailableClasses<ActionBase>();
+      }
+      catch(const std::exception& e)
+      {
+        TEMOTO_PRINT("Could not load library '" + umrf.getLibraryPath() + "': " + std::string(e.what()));
+      }
+    }
+    manifest_it = library_manifests_.emplace(umrf.getLibraryPath(), class_names).first;
+  }
+  const std::vector<std::string>& class_names = manifest_it->second;
+  return std::find(class_names.begin(), class_names.end(), umrf.getName()) != class_names.end();
+}
+
 const std::vector<Umrf>& ActionIndexer::getUmrfs() const
 {
   // Lock the mutex
   std::lock_guard<std::mutex> guard(action_sfs_mutex_);
   return indexed_umrfs_;
+}
+
+const ActionIndexer::LibraryManifests& ActionIndexer::getLibraryManifests() const
+{
+  // Lock the mutex
+  std::lock_guard<std::mutex> guard(action_sfs_mutex_);
+  return library_manifests_;
 }
\ No newline at end of file
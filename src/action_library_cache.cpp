@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_action_engine/action_library_cache.h"
+#include "temoto_action_engine/action_base.h"
+
+ActionLibraryCache::ActionLibraryCache(bool keep_warm)
+: keep_warm_(keep_warm)
+{}
+
+std::shared_ptr<ActionLibraryCache::LibraryEntry> ActionLibraryCache::getEntry(const std::string& library_path)
+{
+  LOCK_GUARD_TYPE guard_libraries(libraries_rw_mutex_);
+  std::shared_ptr<LibraryEntry>& entry = libraries_[library_path];
+  if (!entry)
+  {
+    entry = std::make_shared<LibraryEntry>();
+  }
+  return entry;
+}
+
+std::shared_ptr<class_loader::ClassLoader> ActionLibraryCache::getClassLoader(const std::string& library_path)
+{
+  std::shared_ptr<LibraryEntry> entry = getEntry(library_path);
+  LOCK_GUARD_TYPE guard_load(entry->load_mutex_);
+
+  std::shared_ptr<class_loader::ClassLoader> class_loader = entry->class_loader_.lock();
+  if (!class_loader)
+  {
+    class_loader = std::make_shared<class_loader::ClassLoader>(library_path, false);
+    entry->class_loader_ = class_loader;
+  }
+
+  if (getKeepWarm())
+  {
+    entry->warm_class_loader_ = class_loader;
+  }
+  return class_loader;
+}
+
+bool ActionLibraryCache::containsClass(const std::string& library_path, const std::string& class_name)
+{
+  std::shared_ptr<LibraryEntry> entry = getEntry(library_path);
+  {
+    LOCK_GUARD_TYPE guard_load(entry->load_mutex_);
+    if (entry->classes_known_)
+    {
+      return entry->class_names_.find(class_name) != entry->class_names_.end();
+    }
+  }
+
+  // Enumerate the classes of the library. The loader is kept alive until the classes are cached
+  std::shared_ptr<class_loader::ClassLoader> class_loader = getClassLoader(library_path);
+  LOCK_GUARD_TYPE guard_load(entry->load_mutex_);
+  if (!entry->classes_known_)
+  {
+    std::vector<std::string> class_names = class_loader->getAvailableClasses<ActionBase>();
+    entry->class_names_ = std::set<std::string>(class_names.begin(), class_names.end());
+    entry->classes_known_ = true;
+  }
+  return entry->class_names_.find(class_name) != entry->class_names_.end();
+}
+
+void ActionLibraryCache::setClasses(const std::string& library_path, const std::vector<std::string>& class_names)
+{
+  std::shared_ptr<LibraryEntry> entry = getEntry(library_path);
+  LOCK_GUARD_TYPE guard_load(entry->load_mutex_);
+  entry->class_names_ = std::set<std::string>(class_names.begin(), class_names.end());
+  entry->classes_known_ = true;
+}
+
+void ActionLibraryCache::setKeepWarm(bool keep_warm)
+{
+  {
+    LOCK_GUARD_TYPE guard_libraries(libraries_rw_mutex_);
+    keep_warm_ = keep_warm;
+  }
+  if (!keep_warm)
+  {
+    clear();
+  }
+}
+
+bool ActionLibraryCache::getKeepWarm() const
+{
+  LOCK_GUARD_TYPE guard_libraries(libraries_rw_mutex_);
+  return keep_warm_;
+}
+
+void ActionLibraryCache::clear()
+{
+  // The loaders are released outside of the locks, as unloading a library might take a while
+  std::vector<std::shared_ptr<class_loader::ClassLoader>> released_class_loaders;
+  std::vector<std::shared_ptr<LibraryEntry>> entries;
+  {
+    LOCK_GUARD_TYPE guard_libraries(libraries_rw_mutex_);
+    for (const auto& library : libraries_)
+    {
+      entries.push_back(library.second);
+    }
+  }
+  for (const auto& entry : entries)
+  {
+    LOCK_GUARD_TYPE guard_load(entry->load_mutex_);
+    if (entry->warm_class_loader_)
+    {
+      released_class_loaders.push_back(std::move(entry->warm_class_loader_));
+    }
+  }
+}
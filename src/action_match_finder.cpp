@@ -89,6 +89,9 @@ bool ActionMatchFinder::findMatchingAction(Umrf& umrf_in, const std::vector<Umrf
       umrf_in.setLibraryPath(known_umrf.getLibraryPath());
       umrf_in.setName(known_umrf.getName());
 
+      // If the UMRF describes the known action as is, then all of its instances refer to a single descriptor
+      umrf_in.shareDescriptor(known_umrf);
+
       /*
        * Update parameter PVF fields
        */
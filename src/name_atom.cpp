@@ -0,0 +1,157 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_action_engine/name_atom.h"
+#include "temoto_action_engine/compiler_macros.h"
+#include <memory>
+#include <unordered_map>
+
+namespace
+{
+  /**
+   * @brief Process-wide table of interned names. The entries are nodes of an unordered_map, which keep
+   * their addresses when the map grows, hence the atoms can point to them directly.
+   *
+   */
+  class NameTable
+  {
+  public:
+    static NameTable& instance()
+    {
+      static NameTable name_table;
+      return name_table;
+    }
+
+    const NameAtom::Entry* intern(const std::string& name)
+    {
+      {
+        SHARED_LOCK_GUARD_TYPE_RW guard_names(names_rw_mutex_);
+        auto name_it = names_.find(name);
+        if (name_it != names_.end())
+        {
+          return &(*name_it);
+        }
+      }
+      LOCK_GUARD_TYPE_RW guard_names(names_rw_mutex_);
+      return &(*names_.emplace(name, names_.size()).first);
+    }
+
+    const NameAtom::Entry* lookup(const std::string& name) const
+    {
+      SHARED_LOCK_GUARD_TYPE_RW guard_names(names_rw_mutex_);
+      auto name_it = names_.find(name);
+      return (name_it != names_.end()) ? &(*name_it) : &invalid_entry_;
+    }
+
+    const NameAtom::Entry* invalidEntry() const
+    {
+      return &invalid_entry_;
+    }
+
+    const NamePath& path(const NameAtom::Entry* entry)
+    {
+      {
+        SHARED_LOCK_GUARD_TYPE_RW guard_paths(paths_rw_mutex_);
+        auto path_it = paths_.find(entry);
+        if (path_it != paths_.end())
+        {
+          return *path_it->second;
+        }
+      }
+
+      // The segments are interned without holding the lock of the paths
+      std::unique_ptr<NamePath> path = splitName(entry->first);
+      LOCK_GUARD_TYPE_RW guard_paths(paths_rw_mutex_);
+      return *paths_.emplace(entry, std::move(path)).first->second;
+    }
+
+  private:
+    static std::unique_ptr<NamePath> splitName(const std::string& name)
+    {
+      std::unique_ptr<NamePath> path(new NamePath);
+      std::string::size_type segment_begin = 0;
+      while (segment_begin < name.size())
+      {
+        std::string::size_type segment_end = name.find(':', segment_begin);
+        if (segment_end == std::string::npos)
+        {
+          segment_end = name.size();
+        }
+        if (segment_end != segment_begin)
+        {
+          path->segments.emplace_back(name.substr(segment_begin, segment_end - segment_begin));
+        }
+        segment_begin = segment_end + 1;
+      }
+
+      if (path->segments.empty())
+      {
+        return path;
+      }
+      path->base_name = path->segments.back();
+
+      std::string namespace_name;
+      for (auto segment_it = path->segments.begin(); segment_it != path->segments.end() - 1; ++segment_it)
+      {
+        namespace_name += (namespace_name.empty() ? "" : "::") + segment_it->str();
+      }
+      path->namespace_name = NameAtom(namespace_name);
+      return path;
+    }
+
+    NameTable()
+    : invalid_entry_("", static_cast<unsigned int>(-1))
+    {}
+
+    /// Referred to by the atoms of names that are not interned. Not part of the table
+    const NameAtom::Entry invalid_entry_;
+
+    typedef std::unordered_map<std::string, unsigned int> NameMap;
+    mutable MUTEX_TYPE_RW names_rw_mutex_;
+    GUARDED_VARIABLE(NameMap names_, names_rw_mutex_);
+
+    /// Paths of the interned names, computed on demand
+    typedef std::unordered_map<const NameAtom::Entry*, std::unique_ptr<const NamePath>> PathMap;
+    mutable MUTEX_TYPE_RW paths_rw_mutex_;
+    GUARDED_VARIABLE(PathMap paths_, paths_rw_mutex_);
+  };
+}
+
+NameAtom::NameAtom()
+{
+  // Atoms are default constructed a lot, hence the empty string is looked up only once
+  static const Entry* const empty_entry = NameTable::instance().intern(std::string());
+  entry_ = empty_entry;
+}
+
+NameAtom::NameAtom(const std::string& name)
+: entry_(NameTable::instance().intern(name))
+{}
+
+NameAtom NameAtom::lookup(const std::string& name)
+{
+  return NameAtom(NameTable::instance().lookup(name));
+}
+
+bool NameAtom::valid() const
+{
+  return entry_ != NameTable::instance().invalidEntry();
+}
+
+const NamePath& NameAtom::path() const
+{
+  return NameTable::instance().path(entry_);
+}
@@ -0,0 +1,193 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "temoto_action_engine/action_executor.h"
+#include "temoto_action_engine/umrf_graph.h"
+#include "temoto_action_engine/umrf.h"
+
+/*
+ * Counts the heap allocations of submitting a UMRF graph to the action executor, when the UMRFs are
+ * copied versus when they are moved along the submission path. Building the graph structure (nodes,
+ * relations, parameter binding plans) allocates regardless, hence it is measured separately. Fails if
+ * the UMRFs are copied on the move path, or if the move path allocates more than a couple of times per
+ * node on top of the graph structure.
+ */
+
+namespace
+{
+std::atomic<unsigned long> allocation_count(0);
+}
+
+void* operator new(std::size_t size)
+{
+  allocation_count++;
+  if (void* ptr = std::malloc(size ? size : 1))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+/**
+ * @brief Creates a chain of UMRFs, each with a few input and output parameters
+ */
+std::vector<Umrf> createUmrfChain(unsigned int umrf_count)
+{
+  std::vector<Umrf> umrfs;
+  for (unsigned int i=0; i<umrf_count; i++)
+  {
+    Umrf umrf;
+    umrf.setName("TaAllocationTest");
+    umrf.setSuffix(i);
+    umrf.setId(i);
+    umrf.setEffect("synchronous");
+    umrf.setLibraryPath("libta_allocation_test.so");
+    if (i > 0)
+    {
+      umrf.setParents({Umrf::Relation("TaAllocationTest", i - 1)});
+    }
+    if (i < umrf_count - 1)
+    {
+      umrf.setChildren({Umrf::Relation("TaAllocationTest", i + 1)});
+    }
+
+    ActionParameters parameters;
+    parameters.setParameter(ActionParameters::ParameterContainer("pose::position::x", "number"));
+    parameters.setParameter(ActionParameters::ParameterContainer("pose::position::y", "number"));
+    parameters.setParameter(ActionParameters::ParameterContainer("frame_id", "string"));
+    umrf.setInputParameters(parameters);
+    umrf.setOutputParameters(parameters);
+    umrfs.push_back(std::move(umrf));
+  }
+  return umrfs;
+}
+
+template <class F>
+unsigned long countAllocations(F f)
+{
+  const unsigned long allocation_count_before = allocation_count;
+  f();
+  return allocation_count - allocation_count_before;
+}
+
+int main(int argc, char** argv)
+{
+  const unsigned int umrf_count = (argc > 1) ? std::stoul(argv[1]) : 50;
+  const unsigned long max_allocations_per_node = 2;
+  bool test_passed = true;
+
+  ActionExecutor action_executor;
+
+  /*
+   * Copying a single UMRF
+   */
+  std::vector<Umrf> umrfs_single = createUmrfChain(3);
+  const unsigned long umrf_copied = countAllocations([&]
+  {
+    Umrf umrf_copy(umrfs_single[1]);
+  });
+  std::cout << "Umrf: " << umrf_copied << " allocations when copied" << std::endl;
+
+  /*
+   * Building the graph structure. The UMRFs are copied into the nodes only if they are passed by const reference
+   */
+  std::vector<Umrf> umrfs_structure_copied = createUmrfChain(umrf_count);
+  const unsigned long structure_copied = countAllocations([&]
+  {
+    UmrfGraph umrf_graph("graph", umrfs_structure_copied);
+  });
+
+  std::vector<Umrf> umrfs_structure_moved = createUmrfChain(umrf_count);
+  const unsigned long structure_moved = countAllocations([&]
+  {
+    UmrfGraph umrf_graph("graph", std::move(umrfs_structure_moved));
+  });
+
+  std::cout << "Graph structure with " << umrf_count << " UMRFs: " << structure_copied << " allocations when copied, "
+    << structure_moved << " when moved" << std::endl;
+  if (structure_moved + umrf_count * umrf_copied > structure_copied)
+  {
+    std::cout << "Failed: the UMRFs are copied into the graph nodes when moved" << std::endl;
+    test_passed = false;
+  }
+
+  /*
+   * Submitting the UMRFs to the executor
+   */
+  std::vector<Umrf> umrfs_copied = createUmrfChain(umrf_count);
+  const unsigned long submission_copied = countAllocations([&]
+  {
+    action_executor.addUmrfGraph("graph_copied", umrfs_copied);
+  });
+
+  std::vector<Umrf> umrfs_moved = createUmrfChain(umrf_count);
+  const unsigned long submission_moved = countAllocations([&]
+  {
+    action_executor.addUmrfGraph("graph_moved", std::move(umrfs_moved));
+  });
+
+  std::cout << "addUmrfGraph with " << umrf_count << " UMRFs: " << submission_copied << " allocations when copied, "
+    << submission_moved << " when moved (" << submission_moved - structure_moved << " on top of the graph structure)"
+    << std::endl;
+  if (submission_moved > structure_moved + max_allocations_per_node * umrf_count)
+  {
+    std::cout << "Failed: submitting moved UMRFs allocates more than " << max_allocations_per_node
+      << " times per node on top of the graph structure" << std::endl;
+    test_passed = false;
+  }
+
+  /*
+   * Storing a graph, e.g., in the registry of the executor
+   */
+  UmrfGraph umrf_graph("graph", createUmrfChain(umrf_count));
+  const unsigned long graph_copied = countAllocations([&]
+  {
+    UmrfGraph umrf_graph_copy(umrf_graph);
+  });
+  const unsigned long graph_moved = countAllocations([&]
+  {
+    UmrfGraph umrf_graph_moved(std::move(umrf_graph));
+  });
+
+  std::cout << "UmrfGraph with " << umrf_count << " UMRFs: " << graph_copied << " allocations when copied, "
+    << graph_moved << " when moved" << std::endl;
+  if (graph_moved > max_allocations_per_node * umrf_count)
+  {
+    std::cout << "Failed: moving a graph allocates more than " << max_allocations_per_node << " times per node" << std::endl;
+    test_passed = false;
+  }
+
+  std::cout << (test_passed ? "Passed" : "Failed") << std::endl;
+  return test_passed ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "temoto_action_engine/action_handle.h"
+#include "temoto_action_engine/umrf.h"
+#include "temoto_action_engine/basic_timer.h"
+
+/*
+ * Reports the footprint of the action handle and the cost of creating and destroying the handles of
+ * a large graph. The handles are created without an executor, i.e., no action libraries are loaded.
+ */
+
+int main(int argc, char** argv)
+{
+  const unsigned int handle_count = (argc > 1) ? std::stoul(argv[1]) : 100000;
+
+  std::cout << "sizeof(ActionHandle): " << sizeof(ActionHandle) << " bytes" << std::endl;
+  std::cout << "sizeof(Umrf): " << sizeof(Umrf) << " bytes" << std::endl;
+  std::cout << "sizeof(ActionParameters): " << sizeof(ActionParameters) << " bytes" << std::endl;
+
+  Umrf umrf;
+  umrf.setName("TaBenchmark");
+  umrf.setLibraryPath("libta_benchmark.so");
+  umrf.setEffect("synchronous");
+
+  // The handles report the missing executor, which is expected here
+  std::ostringstream discarded_output;
+  std::streambuf* cout_buffer = std::cout.rdbuf(discarded_output.rdbuf());
+
+  std::vector<std::shared_ptr<ActionHandle>> action_handles;
+  action_handles.reserve(handle_count);
+
+  Timer timer;
+  for (unsigned int i=0; i<handle_count; i++)
+  {
+    Umrf handle_umrf(umrf);
+    handle_umrf.setId(i);
+    action_handles.push_back(std::make_shared<ActionHandle>(std::move(handle_umrf), nullptr));
+  }
+  const double creation_time = timer.elapsed();
+
+  timer.reset();
+  action_handles.clear();
+  const double destruction_time = timer.elapsed();
+
+  std::cout.rdbuf(cout_buffer);
+
+  std::cout << "Created " << handle_count << " handles in " << creation_time * 1000 << " ms ("
+    << creation_time * 1e9 / handle_count << " ns per handle)" << std::endl;
+  std::cout << "Destroyed " << handle_count << " handles in " << destruction_time * 1000 << " ms ("
+    << destruction_time * 1e9 / handle_count << " ns per handle)" << std::endl;
+
+  return 0;
+}
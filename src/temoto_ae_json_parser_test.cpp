@@ -0,0 +1,163 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "temoto_action_engine/umrf_json_converter.h"
+#include "temoto_action_engine/temoto_error.h"
+#include "temoto_action_engine/messaging.h"
+
+/*
+ * Parses UMRF and UMRF graph JSONs with both the DOM and the SAX parser and checks that the results
+ * are identical. Besides the given files, a set of ill formatted parameter cases is checked, which
+ * must be handled in the same way by both parsers.
+ */
+
+const std::string app_name = "AE_json_parser_test";
+
+const std::vector<std::string> PARAMETER_CASES = {
+  R"({"a": {"pvf_type": "string", "pvf_value": "x"}, "b": {"c": {"pvf_type": "number", "pvf_value": 2}}})",
+  R"({"a": {"pvf_value": "x", "pvf_type": "string", "pvf_example": "y", "d": {"e": 1}}})",
+  R"({"a": {"pvf_type": "string"}, "b": {"pvf_value": "x"}})",
+  R"({"a": {"pvf_type": "string"}, "b": {"pvf_allowed_values": ["x", "y"]}})",
+  R"({"a": {"pvf_type": "string"}, "b": {"pvf_value": {"pvf_type": "number"}}})",
+  R"({"a": {"pvf_type": "string"}, "b": 1})",
+  R"({"a": {"pvf_type": "string"}, "b": [1, 2]})",
+  R"({"a": {"pvf_type": "string", "pvf_allowed_values": ["x"]}})"
+};
+
+/**
+ * @brief Result of parsing a JSON string: either the UMRFs converted back to JSON, or the parsing error
+ */
+struct ParseResult
+{
+  bool success = false;
+  std::string graph_name;
+  std::vector<std::string> umrf_json_strs;
+};
+
+ParseResult parseUmrf(const std::string& json_str, umrf_json_converter::JsonParser parser)
+{
+  ParseResult result;
+  try
+  {
+    Umrf umrf = umrf_json_converter::fromUmrfJsonStr(json_str, false, parser);
+    result.umrf_json_strs.push_back(umrf_json_converter::toUmrfJsonStr(umrf));
+    result.success = true;
+  }
+  catch(TemotoErrorStack e)
+  {}
+  return result;
+}
+
+ParseResult parseUmrfGraph(const std::string& json_str, umrf_json_converter::JsonParser parser)
+{
+  ParseResult result;
+  try
+  {
+    UmrfGraph umrf_graph = umrf_json_converter::fromUmrfGraphJsonStr(json_str, parser);
+    result.graph_name = umrf_graph.getName();
+    for (const auto& umrf : umrf_graph.getUmrfs())
+    {
+      result.umrf_json_strs.push_back(umrf_json_converter::toUmrfJsonStr(umrf));
+    }
+    result.success = true;
+  }
+  catch(TemotoErrorStack e)
+  {}
+  return result;
+}
+
+bool compare(const std::string& test_name, const ParseResult& dom_result, const ParseResult& sax_result)
+{
+  if (dom_result.success != sax_result.success ||
+      dom_result.graph_name != sax_result.graph_name ||
+      dom_result.umrf_json_strs != sax_result.umrf_json_strs)
+  {
+    TEMOTO_PRINT_OF("Parsers disagree on " + test_name, app_name);
+    for (const auto& umrf_json_str : dom_result.umrf_json_strs)
+    {
+      std::cout << "DOM: " << umrf_json_str << std::endl;
+    }
+    for (const auto& umrf_json_str : sax_result.umrf_json_strs)
+    {
+      std::cout << "SAX: " << umrf_json_str << std::endl;
+    }
+    return false;
+  }
+  TEMOTO_PRINT_OF("Parsers agree on " + test_name + (dom_result.success ? "" : " (rejected by both)"), app_name);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cout << "Usage: temoto_ae_json_parser_test <json base path> [json file names ...]\n";
+    return 1;
+  }
+
+  std::string base_path(argv[1]);
+  std::vector<std::string> json_names = {"umrf_0.json", "umrf_1.json", "umrf_2.json", "umrf_3.json"};
+  if (argc > 2)
+  {
+    json_names.assign(argv + 2, argv + argc);
+  }
+
+  bool parsers_agree = true;
+  for (const auto& json_name : json_names)
+  {
+    std::string json_full_path = base_path + json_name;
+    std::ifstream ifs(json_full_path);
+    if (!ifs.good())
+    {
+      TEMOTO_PRINT_OF("Cannot open " + json_full_path, app_name);
+      parsers_agree = false;
+      continue;
+    }
+    std::string json_str;
+    json_str.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+    // Graphs are recognized by their list of UMRFs
+    if (json_str.find(umrf_json_converter::UMRF_FIELDS.umrf_actions) != std::string::npos)
+    {
+      parsers_agree &= compare(json_full_path
+      , parseUmrfGraph(json_str, umrf_json_converter::JsonParser::DOM)
+      , parseUmrfGraph(json_str, umrf_json_converter::JsonParser::SAX));
+    }
+    else
+    {
+      parsers_agree &= compare(json_full_path
+      , parseUmrf(json_str, umrf_json_converter::JsonParser::DOM)
+      , parseUmrf(json_str, umrf_json_converter::JsonParser::SAX));
+    }
+  }
+
+  for (unsigned int i=0; i<PARAMETER_CASES.size(); i++)
+  {
+    const std::string json_str = R"({"name": "TaTest", "effect": "synchronous", "id": 0, "input_parameters": )"
+      + PARAMETER_CASES[i] + "}";
+    parsers_agree &= compare("parameter case " + std::to_string(i)
+    , parseUmrf(json_str, umrf_json_converter::JsonParser::DOM)
+    , parseUmrf(json_str, umrf_json_converter::JsonParser::SAX));
+  }
+
+  return parsers_agree ? 0 : 1;
+}
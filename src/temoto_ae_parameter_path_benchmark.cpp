@@ -0,0 +1,134 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+
+#include "temoto_action_engine/action_parameters.h"
+#include "temoto_action_engine/umrf.h"
+#include "temoto_action_engine/umrf_json_converter.h"
+#include "temoto_action_engine/basic_timer.h"
+
+/*
+ * Measures the namespace operations and the JSON serialization of deeply nested parameter sets. The
+ * namespace operations are compared against splitting the names on every call, as done before the
+ * parameter names were stored as precomputed paths.
+ */
+
+/**
+ * @brief Creates parameters named "ns_0_<i>::ns_1_<i>::...::leaf_<i>" with the given nesting depth
+ */
+ActionParameters createNestedParameters(unsigned int parameter_count, unsigned int depth)
+{
+  ActionParameters parameters;
+  for (unsigned int i=0; i<parameter_count; i++)
+  {
+    std::string name;
+    for (unsigned int level=0; level<depth; level++)
+    {
+      // Parameters share the upper levels of the namespace, as in the JSON tree of a UMRF
+      name += "ns_" + std::to_string(level) + "_" + std::to_string(i % (level + 2)) + "::";
+    }
+    name += "leaf_" + std::to_string(i);
+    ActionParameters::ParameterContainer pc(name, "number");
+    pc.setData(static_cast<double>(i));
+    parameters.setParameter(pc);
+  }
+  return parameters;
+}
+
+int main(int argc, char** argv)
+{
+  const unsigned int parameter_count = (argc > 1) ? std::stoul(argv[1]) : 1000;
+  const unsigned int depth = (argc > 2) ? std::stoul(argv[2]) : 8;
+  const unsigned int repetitions = 100;
+
+  ActionParameters parameters = createNestedParameters(parameter_count, depth);
+  const double operation_count = static_cast<double>(parameters.getParameterCount()) * repetitions;
+  std::cout << parameters.getParameterCount() << " parameters, nesting depth " << depth << std::endl;
+
+  /*
+   * Namespace lookups via the precomputed paths
+   */
+  size_t checksum = 0;
+  Timer timer;
+  for (unsigned int r=0; r<repetitions; r++)
+  {
+    for (const auto& parameter : parameters)
+    {
+      checksum += parameter.getNameNoNamespace().size() + parameter.getNamespaceName().size();
+    }
+  }
+  const double path_time = timer.elapsed();
+
+  /*
+   * Namespace lookups by splitting the names
+   */
+  timer.reset();
+  for (unsigned int r=0; r<repetitions; r++)
+  {
+    for (const auto& parameter : parameters)
+    {
+      std::vector<std::string> name_segments;
+      boost::split(name_segments, parameter.getName(), boost::is_any_of("::"));
+      const std::string& base_name = name_segments.back();
+      checksum += base_name.size() + parameter.getName().size() - base_name.size() - 2;
+    }
+  }
+  const double split_time = timer.elapsed();
+
+  std::cout << "Namespace lookup via paths: " << path_time * 1e9 / operation_count << " ns per parameter" << std::endl;
+  std::cout << "Namespace lookup via split: " << split_time * 1e9 / operation_count << " ns per parameter" << std::endl;
+
+  /*
+   * Renaming the parameters within their namespaces
+   */
+  timer.reset();
+  for (const auto& parameter : parameters)
+  {
+    ActionParameters::ParameterContainer pc(parameter);
+    pc.setNameKeepNamespace("renamed");
+    pc.removeNamespaceLevel();
+    checksum += pc.getNameNoNamespace().size();
+  }
+  const double rename_time = timer.elapsed();
+  std::cout << "Rename and remove a namespace level: " << rename_time * 1e9 / parameters.getParameterCount()
+    << " ns per parameter" << std::endl;
+
+  /*
+   * Building the JSON tree of the parameters
+   */
+  Umrf umrf;
+  umrf.setName("TaBenchmark");
+  umrf.setSuffix(0);
+  umrf.setEffect("synchronous");
+  umrf.setInputParameters(parameters);
+
+  timer.reset();
+  for (unsigned int r=0; r<repetitions; r++)
+  {
+    checksum += umrf_json_converter::toUmrfJsonStr(umrf).size();
+  }
+  const double json_time = timer.elapsed();
+  std::cout << "UMRF to JSON: " << json_time * 1e6 / repetitions << " us per UMRF" << std::endl;
+
+  // Keeps the measured work from being optimized away
+  std::cout << "Checksum: " << checksum << std::endl;
+  return 0;
+}
@@ -20,41 +20,89 @@
 #include "temoto_action_engine/temoto_error.h"
 #include <iostream>
 
+namespace
+{
+  /// All default constructed UMRFs share the same empty descriptor until they are modified
+  const std::shared_ptr<Umrf::Descriptor>& emptyDescriptor()
+  {
+    static const std::shared_ptr<Umrf::Descriptor> empty_descriptor = std::make_shared<Umrf::Descriptor>();
+    return empty_descriptor;
+  }
+}
+
 Umrf::Umrf()
+: descriptor_(emptyDescriptor())
 {}
 
 Umrf::Umrf(const Umrf& uj)
-: name_(uj.name_)
-, description_(uj.description_)
-, package_name_(uj.package_name_)
+: descriptor_(uj.descriptor_)
 , suffix_(uj.suffix_)
-, notation_(uj.notation_)
-, effect_(uj.effect_)
-, library_path_(uj.library_path_)
 , parents_(uj.parents_)
 , children_(uj.children_)
-, id_(uj.id_)
-, full_name_(uj.full_name_)
 , input_parameters_(uj.input_parameters_)
 , output_parameters_(uj.output_parameters_)
+, id_(uj.id_)
+, full_name_(uj.full_name_)
 {}
 
+Umrf::Umrf(Umrf&& uj) noexcept
+: descriptor_(std::move(uj.descriptor_))
+, suffix_(uj.suffix_)
+, parents_(std::move(uj.parents_))
+, children_(std::move(uj.children_))
+, input_parameters_(std::move(uj.input_parameters_))
+, output_parameters_(std::move(uj.output_parameters_))
+, id_(uj.id_)
+, full_name_(std::move(uj.full_name_))
+{
+  // The descriptor must never be null, hence the moved-from UMRF falls back to the shared empty descriptor
+  uj.descriptor_ = emptyDescriptor();
+}
+
+Umrf::Descriptor& Umrf::detachDescriptor()
+{
+  // If the count is 1, then no other UMRF can start sharing the descriptor concurrently, as that would
+  // require reading this UMRF while it's being modified
+  if (descriptor_.use_count() != 1)
+  {
+    descriptor_ = std::make_shared<Descriptor>(*descriptor_);
+  }
+  return *descriptor_;
+}
+
+bool Umrf::shareDescriptor(const Umrf& umrf)
+{
+  if (descriptor_ == umrf.descriptor_)
+  {
+    return true;
+  }
+  if (!(*descriptor_ == *umrf.descriptor_))
+  {
+    return false;
+  }
+  descriptor_ = umrf.descriptor_;
+  return true;
+}
+
 const std::string& Umrf::getName() const
 {
-  return name_;
+  return descriptor_->name_.str();
 }
 
-std::string& Umrf::getNameNc()
+const NameAtom& Umrf::getNameAtom() const
 {
-  return name_;
+  return descriptor_->name_;
 }
 
 bool Umrf::setName(const std::string& name)
 {
   if (!name.empty())
   {
-    name_ = name;
-    full_name_ = name_ + "_" + std::to_string(suffix_);
+    if (name != getName())
+    {
+      detachDescriptor().name_ = NameAtom(name);
+    }
+    full_name_ = NameAtom(name + "_" + std::to_string(suffix_));
     return true;  
   }
   else
@@ -65,24 +113,31 @@ bool Umrf::setName(const std::string& name)
 
 const std::string& Umrf::getPackageName() const
 {
-  return package_name_;
+  return descriptor_->package_name_;
 }
 
 const std::string& Umrf::getDescription() const
 {
-  return description_;
+  return descriptor_->description_;
 }
 
 bool Umrf::setDescription(const std::string& description)
 {
-  description_ = description;
+  if (description != descriptor_->description_)
+  {
+    detachDescriptor().description_ = description;
+  }
+  return true;
 }
 
 bool Umrf::setPackageName(const std::string& package_name)
 {
   if (!package_name.empty())
   {
-    package_name_ = package_name;
+    if (package_name != descriptor_->package_name_)
+    {
+      detachDescriptor().package_name_ = package_name;
+    }
     return true;  
   }
   else
@@ -92,20 +147,28 @@ bool Umrf::setPackageName(const std::string& package_name)
 }
 
 const std::string& Umrf::getFullName() const
+{
+  return full_name_.str();
+}
+
+const NameAtom& Umrf::getFullNameAtom() const
 {
   return full_name_;
 }
 
 const std::string& Umrf::getLibraryPath() const
 {
-  return library_path_;
+  return descriptor_->library_path_;
 }
 
 bool Umrf::setLibraryPath(const std::string& library_path)
 {
   if (!library_path.empty())
   {
-    library_path_ = library_path;
+    if (library_path != descriptor_->library_path_)
+    {
+      detachDescriptor().library_path_ = library_path;
+    }
     return true;  
   }
   else
@@ -218,19 +281,22 @@ bool Umrf::removeChild(const Umrf::Relation& child)
 
 const std::string& Umrf::getEffect() const
 {
-  return effect_;
+  return descriptor_->effect_;
 }
 
 std::string& Umrf::getEffectNc()
 {
-  return effect_;
+  return detachDescriptor().effect_;
 }
 
 bool Umrf::setEffect(const std::string& effect)
 {
   if (!effect.empty())
   {
-    effect_ = effect;
+    if (effect != descriptor_->effect_)
+    {
+      detachDescriptor().effect_ = effect;
+    }
     return true;  
   }
   else
@@ -247,20 +313,23 @@ bool Umrf::setSuffix(const unsigned int& suffix)
 {
 
   suffix_ = suffix;
-  full_name_ = name_ + "_" + std::to_string(suffix_);
+  full_name_ = NameAtom(getName() + "_" + std::to_string(suffix_));
   return true;  
 }
 
 const std::string& Umrf::getNotation() const
 {
-  return notation_;
+  return descriptor_->notation_;
 }
 
 bool Umrf::setNotation(const std::string& notation)
 {
   if (!notation.empty())
   {
-    notation_ = notation;
+    if (notation != descriptor_->notation_)
+    {
+      detachDescriptor().notation_ = notation;
+    }
     return true;  
   }
   else
@@ -351,6 +420,22 @@ bool Umrf::copyInputParameters(const ActionParameters& action_parameters)
   return inputParametersReceived();
 }
 
+bool Umrf::copyInputParameters(const ActionParameters& action_parameters, const ActionParameters::BindingPlan& binding_plan)
+{
+  LOCK_GUARD_TYPE_R guard_input_params(input_params_rw_mutex_);
+  if (!input_parameters_.applyBindingPlan(binding_plan, action_parameters))
+  {
+    input_parameters_.copyParameters(action_parameters);
+  }
+  return inputParametersReceived();
+}
+
+ActionParameters::BindingPlan Umrf::createInputBindingPlan(const ActionParameters& action_parameters) const
+{
+  LOCK_GUARD_TYPE_R guard_input_params(input_params_rw_mutex_);
+  return input_parameters_.createBindingPlan(action_parameters);
+}
+
 bool Umrf::inputParametersReceived() const
 {
   LOCK_GUARD_TYPE_R guard_input_params(input_params_rw_mutex_);
@@ -433,7 +518,8 @@ bool Umrf::updateInputParams(const Umrf& umrf_in)
     for (const auto& input_param_in : umrf_in.getInputParameters())
     {
       // Get the parameter
-      if (input_parameters_.getParameters().find(input_param_in) == input_parameters_.end())
+      const ActionParameters::ParameterContainer* input_param_loc = input_parameters_.findParameter(input_param_in.getNameAtom());
+      if (input_param_loc == nullptr)
       {
         for (const auto& p : input_parameters_.getParameters())
         {
@@ -443,10 +529,8 @@ bool Umrf::updateInputParams(const Umrf& umrf_in)
         continue;
       }
 
-      const ActionParameters::ParameterContainer& input_param_loc = *input_parameters_.getParameters().find(input_param_in);
-
       // Skip that parameter if it's not updatable
-      if (!input_param_loc.isUpdatable())
+      if (!input_param_loc->isUpdatable())
       {
         continue;
       }
@@ -474,10 +558,14 @@ bool Umrf::isEqual(const Umrf& umrf_in, bool check_updatable) const
   /*
    * Compare the general parameters
    */
-  if ((name_ != umrf_in.name_) ||
-      (suffix_ != umrf_in.suffix_) ||
-      (notation_ != umrf_in.notation_) ||
-      (effect_ != umrf_in.effect_))
+  if (suffix_ != umrf_in.suffix_)
+  {
+    return false;
+  }
+  if ((descriptor_ != umrf_in.descriptor_) &&
+      ((getNameAtom() != umrf_in.getNameAtom()) ||
+       (getNotation() != umrf_in.getNotation()) ||
+       (getEffect() != umrf_in.getEffect())))
   {
     return false;
   }
@@ -573,7 +661,7 @@ bool Umrf::isEqual(const Umrf& umrf_in, bool check_updatable) const
 
 Umrf::Relation Umrf::asRelation() const
 {
-  return Umrf::Relation(getName(), getSuffix());
+  return Umrf::Relation(getNameAtom(), getSuffix(), getFullNameAtom());
 }
 
 bool Umrf::requiredParentsFinished() const
@@ -600,4 +688,15 @@ void Umrf::setParentReceived(const Umrf::Relation& parent)
   {
     throw CREATE_TEMOTO_ERROR_STACK("The parent does not exist");
   }
+}
+
+bool Umrf::setParentReceived(const unsigned int& parent_index)
+{
+  if (parent_index >= parents_.size())
+  {
+    throw CREATE_TEMOTO_ERROR_STACK("The parent does not exist");
+  }
+  bool received_before = parents_[parent_index].received_;
+  parents_[parent_index].received_ = true;
+  return !received_before;
 }
\ No newline at end of file
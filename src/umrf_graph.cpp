@@ -18,15 +18,38 @@
 
 #include "temoto_action_engine/umrf_graph.h"
 #include <iostream>
+#include <algorithm>
 
 GraphNode::GraphNode(const Umrf& umrf)
 : umrf_(umrf)
 , state_(GraphNode::State::UNINITIALIZED)
+, nr_of_pending_required_parents_(0)
+{}
+
+GraphNode::GraphNode(Umrf&& umrf)
+: umrf_(std::move(umrf))
+, state_(GraphNode::State::UNINITIALIZED)
+, nr_of_pending_required_parents_(0)
 {}
 
 GraphNode::GraphNode(const GraphNode& gn)
 : umrf_(gn.umrf_)
 , state_(gn.state_)
+, child_ids_(gn.child_ids_)
+, parent_ids_(gn.parent_ids_)
+, child_parent_slots_(gn.child_parent_slots_)
+, child_binding_plans_(gn.child_binding_plans_)
+, nr_of_pending_required_parents_(gn.nr_of_pending_required_parents_.load())
+{}
+
+GraphNode::GraphNode(GraphNode&& gn)
+: umrf_(std::move(gn.umrf_))
+, state_(gn.state_)
+, child_ids_(std::move(gn.child_ids_))
+, parent_ids_(std::move(gn.parent_ids_))
+, child_parent_slots_(std::move(gn.child_parent_slots_))
+, child_binding_plans_(std::move(gn.child_binding_plans_))
+, nr_of_pending_required_parents_(gn.nr_of_pending_required_parents_.load())
 {}
 
 UmrfGraph::UmrfGraph(const std::string& graph_name)
@@ -45,6 +68,21 @@ UmrfGraph::UmrfGraph(const std::string& graph_name, const std::vector<Umrf>& umr
   }
 }
 
+UmrfGraph::UmrfGraph(const std::string& graph_name, std::vector<Umrf>&& umrfs_vec, bool initialize_graph)
+: state_(State::UNINITIALIZED)
+, graph_name_(graph_name)
+{
+  // The UMRFs are moved into the graph nodes, umrfs_vec_ is filled on demand by getUmrfs
+  if (initialize_graph)
+  {
+    initialize(std::move(umrfs_vec));
+  }
+  else
+  {
+    umrfs_vec_ = std::move(umrfs_vec);
+  }
+}
+
 UmrfGraph::UmrfGraph(const UmrfGraph& ugh)
 : graph_nodes_map_(ugh.graph_nodes_map_)
 , name_id_map_(ugh.name_id_map_)
@@ -52,9 +90,34 @@ UmrfGraph::UmrfGraph(const UmrfGraph& ugh)
 , state_(ugh.state_)
 , graph_name_(ugh.graph_name_)
 , umrfs_vec_ (ugh.umrfs_vec_)
+, nr_of_uninitialized_nodes_(ugh.nr_of_uninitialized_nodes_)
+, nr_of_initialized_nodes_(ugh.nr_of_initialized_nodes_)
+, nr_of_active_nodes_(ugh.nr_of_active_nodes_)
+, nr_of_finished_nodes_(ugh.nr_of_finished_nodes_)
+, nr_of_errored_nodes_(ugh.nr_of_errored_nodes_)
+{}
+
+UmrfGraph::UmrfGraph(UmrfGraph&& ugh)
+: graph_nodes_map_(std::move(ugh.graph_nodes_map_))
+, name_id_map_(std::move(ugh.name_id_map_))
+, root_node_ids_(std::move(ugh.root_node_ids_))
+, state_(ugh.state_)
+, graph_name_(std::move(ugh.graph_name_))
+, graph_description_(std::move(ugh.graph_description_))
+, umrfs_vec_ (std::move(ugh.umrfs_vec_))
+, nr_of_uninitialized_nodes_(ugh.nr_of_uninitialized_nodes_)
+, nr_of_initialized_nodes_(ugh.nr_of_initialized_nodes_)
+, nr_of_active_nodes_(ugh.nr_of_active_nodes_)
+, nr_of_finished_nodes_(ugh.nr_of_finished_nodes_)
+, nr_of_errored_nodes_(ugh.nr_of_errored_nodes_)
 {}
 
 bool UmrfGraph::initialize(const std::vector<Umrf>& umrfs_vec)
+{
+  return initialize(std::vector<Umrf>(umrfs_vec));
+}
+
+bool UmrfGraph::initialize(std::vector<Umrf>&& umrfs_vec)
 {
   LOCK_GUARD_TYPE guard_state(state_rw_mutex_);
   if (state_ != UmrfGraph::State::UNINITIALIZED)
@@ -62,11 +125,23 @@ bool UmrfGraph::initialize(const std::vector<Umrf>& umrfs_vec)
     return true;
   }
 
-  if (!createMaps(umrfs_vec))
+  if (!createMaps(std::move(umrfs_vec)))
   {
     std::cout << "Could not create the UMRF name to ID resolving maps." << std::endl;;
     return false;
   }
+
+  try
+  {
+    LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+    LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
+    resolveRelations();
+  }
+  catch(TemotoErrorStack e)
+  {
+    std::cout << e.what() << std::endl;
+    return false;
+  }
   if (!findRootNodes())
   {
     std::cout << "Could not find root nodes. UMRF graph must have at least one acyclic root node." << std::endl;
@@ -96,21 +171,25 @@ const std::string UmrfGraph::getDescription() const
   return graph_description_;
 }
 
-bool UmrfGraph::createMaps(const std::vector<Umrf>& umrfs_vec)
+bool UmrfGraph::createMaps(std::vector<Umrf>&& umrfs_vec)
 {
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  for (const auto& umrf : umrfs_vec)
+  for (auto& umrf : umrfs_vec)
   {
     try
     {
-      bool success = graph_nodes_map_.emplace(umrf.getId(), umrf).second &&
-        name_id_map_.emplace(umrf.getFullName(), umrf.getId()).second;
+      // The ID and the name are read before the UMRF is moved into its node
+      const unsigned int umrf_id = umrf.getId();
+      const NameAtom umrf_full_name = umrf.getFullNameAtom();
+      bool success = graph_nodes_map_.emplace(umrf_id, std::move(umrf)).second &&
+        name_id_map_.emplace(umrf_full_name, umrf_id).second;
       if (!success)
       {
         return false;
       }
+      getNodeStateCount(GraphNode::State::UNINITIALIZED)++;
     }
     catch(const std::exception& e)
     {
@@ -166,34 +245,212 @@ bool UmrfGraph::partOfGraph(const unsigned int& node_id) const
 }
 
 bool UmrfGraph::partOfGraph(const std::string& node_name) const
+{
+  return partOfGraph(NameAtom::lookup(node_name));
+}
+
+bool UmrfGraph::partOfGraph(const NameAtom& node_name) const
 {
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
   return (name_id_map_.find(node_name) != name_id_map_.end());
 }
 
-std::vector<unsigned int> UmrfGraph::getChildrenOf(const unsigned int& node_id) const
+void UmrfGraph::resolveRelations()
 {
-  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
-  LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
+  for (auto& graph_node_pair : graph_nodes_map_)
+  {
+    resolveRelationsOf(graph_node_pair.second);
+  }
+}
 
-  std::vector<unsigned int> child_node_ids;
-  if (partOfGraph(node_id))
+void UmrfGraph::resolveRelations(const std::set<unsigned int>& node_ids)
+{
+  for (const auto& node_id : node_ids)
+  {
+    auto graph_node_it = graph_nodes_map_.find(node_id);
+    if (graph_node_it != graph_nodes_map_.end())
+    {
+      resolveRelationsOf(graph_node_it->second);
+    }
+  }
+}
+
+void UmrfGraph::collectWithParents(const unsigned int& node_id, std::set<unsigned int>& node_ids) const
+{
+  auto graph_node_it = graph_nodes_map_.find(node_id);
+  if (graph_node_it == graph_nodes_map_.end())
+  {
+    return;
+  }
+  node_ids.insert(node_id);
+  for (const auto& parent_node_relation : graph_node_it->second.umrf_.getParents())
+  {
+    auto name_id_it = name_id_map_.find(parent_node_relation.getFullNameAtom());
+    if (name_id_it != name_id_map_.end())
+    {
+      node_ids.insert(name_id_it->second);
+    }
+  }
+}
+
+void UmrfGraph::validateRelations() const
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  for (const auto& graph_node_pair : graph_nodes_map_)
   {
-    for (const auto& child_node_relation : graph_nodes_map_.at(node_id).umrf_.getChildren())
+    const GraphNode& graph_node = graph_node_pair.second;
+    for (unsigned int i=0; i<graph_node.child_ids_.size(); i++)
     {
-      try
+      if (graph_node.child_parent_slots_[i] == GraphNode::NO_PARENT_SLOT)
       {
-        child_node_ids.push_back(name_id_map_.at(child_node_relation.getFullName()));
+        throw CREATE_TEMOTO_ERROR_STACK("Action '" + graph_nodes_map_.at(graph_node.child_ids_[i]).umrf_.getFullName()
+          + "' does not list '" + graph_node.umrf_.getFullName() + "' as its parent in UMRF graph '" + graph_name_ + "'.");
       }
-      catch(const std::exception& e)
+    }
+    for (const auto& parent_id : graph_node.parent_ids_)
+    {
+      const std::vector<unsigned int>& siblings = graph_nodes_map_.at(parent_id).child_ids_;
+      if (std::find(siblings.begin(), siblings.end(), graph_node_pair.first) == siblings.end())
       {
-        throw CREATE_TEMOTO_ERROR_STACK("Could not find an action named '" + child_node_relation.getFullName()
-          + "' in UMRF graph '" + graph_name_ + "'. "
-          + "Check if the UMRF graph has correct parent/children names.");
+        throw CREATE_TEMOTO_ERROR_STACK("Action '" + graph_nodes_map_.at(parent_id).umrf_.getFullName()
+          + "' does not list '" + graph_node.umrf_.getFullName() + "' as its child in UMRF graph '" + graph_name_ + "'.");
       }
     }
   }
-  return std::move(child_node_ids);
+}
+
+void UmrfGraph::resolveRelationsOf(GraphNode& graph_node)
+{
+  const Umrf::Relation graph_node_relation = graph_node.umrf_.asRelation();
+
+  graph_node.child_ids_.clear();
+  graph_node.child_parent_slots_.clear();
+  graph_node.child_binding_plans_.clear();
+  graph_node.child_ids_.reserve(graph_node.umrf_.getChildren().size());
+  graph_node.child_parent_slots_.reserve(graph_node.umrf_.getChildren().size());
+  graph_node.child_binding_plans_.reserve(graph_node.umrf_.getChildren().size());
+  for (const auto& child_node_relation : graph_node.umrf_.getChildren())
+  {
+    auto name_id_it = name_id_map_.find(child_node_relation.getFullNameAtom());
+    if (name_id_it == name_id_map_.end())
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Could not find an action named '" + child_node_relation.getFullName()
+        + "' in UMRF graph '" + graph_name_ + "'. "
+        + "Check if the UMRF graph has correct parent/children names.");
+    }
+
+    // Find the position of this node in the parents list of the child, if the child lists it at all
+    const Umrf& child_umrf = graph_nodes_map_.at(name_id_it->second).umrf_;
+    const std::vector<Umrf::Relation>& child_parents = child_umrf.getParents();
+    auto parent_slot_it = std::find(child_parents.begin(), child_parents.end(), graph_node_relation);
+    graph_node.child_ids_.push_back(name_id_it->second);
+    graph_node.child_parent_slots_.push_back((parent_slot_it == child_parents.end())
+      ? GraphNode::NO_PARENT_SLOT
+      : parent_slot_it - child_parents.begin());
+    graph_node.child_binding_plans_.push_back(child_umrf.createInputBindingPlan(graph_node.umrf_.getOutputParameters()));
+  }
+
+  graph_node.parent_ids_.clear();
+  graph_node.parent_ids_.reserve(graph_node.umrf_.getParents().size());
+  unsigned int nr_of_pending_required_parents = 0;
+  for (const auto& parent_node_relation : graph_node.umrf_.getParents())
+  {
+    auto name_id_it = name_id_map_.find(parent_node_relation.getFullNameAtom());
+    if (name_id_it == name_id_map_.end())
+    {
+      throw CREATE_TEMOTO_ERROR_STACK("Could not find an action named '" + parent_node_relation.getFullName()
+        + "' in UMRF graph '" + graph_name_ + "'. "
+        + "Check if the UMRF graph has correct parent/children names.");
+    }
+    graph_node.parent_ids_.push_back(name_id_it->second);
+
+    if (parent_node_relation.getRequired() && !parent_node_relation.getReceived())
+    {
+      nr_of_pending_required_parents++;
+    }
+  }
+  graph_node.nr_of_pending_required_parents_ = nr_of_pending_required_parents;
+}
+
+std::vector<unsigned int> UmrfGraph::markParentFinished(const unsigned int& parent_id)
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  std::vector<unsigned int> ready_child_ids;
+
+  auto parent_node_it = graph_nodes_map_.find(parent_id);
+  if (parent_node_it == graph_nodes_map_.end())
+  {
+    return ready_child_ids;
+  }
+  const GraphNode& parent_node = parent_node_it->second;
+
+  for (unsigned int i=0; i<parent_node.child_ids_.size(); i++)
+  {
+    GraphNode& child_node = graph_nodes_map_.at(parent_node.child_ids_[i]);
+    const unsigned int& parent_slot = parent_node.child_parent_slots_[i];
+
+    // Only the first notification of a required parent counts towards the readiness of the child. A parent
+    // which is not listed by the child is never required
+    unsigned int nr_of_pending_required_parents;
+    if (parent_slot != GraphNode::NO_PARENT_SLOT &&
+        child_node.umrf_.setParentReceived(parent_slot) &&
+        child_node.umrf_.getParents()[parent_slot].getRequired())
+    {
+      nr_of_pending_required_parents = --child_node.nr_of_pending_required_parents_;
+    }
+    else
+    {
+      nr_of_pending_required_parents = child_node.nr_of_pending_required_parents_;
+    }
+
+    // Children that are active or have already finished or failed are not executed again
+    if (nr_of_pending_required_parents == 0 &&
+       (child_node.state_ == GraphNode::State::UNINITIALIZED || child_node.state_ == GraphNode::State::INITIALIZED))
+    {
+      ready_child_ids.push_back(parent_node.child_ids_[i]);
+    }
+  }
+  return ready_child_ids;
+}
+
+const std::vector<unsigned int>& UmrfGraph::getChildrenOf(const unsigned int& node_id) const
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  static const std::vector<unsigned int> no_nodes;
+
+  auto graph_node_it = graph_nodes_map_.find(node_id);
+  if (graph_node_it == graph_nodes_map_.end())
+  {
+    return no_nodes;
+  }
+  return graph_node_it->second.child_ids_;
+}
+
+const std::vector<unsigned int>& UmrfGraph::getParentsOf(const unsigned int& node_id) const
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  static const std::vector<unsigned int> no_nodes;
+
+  auto graph_node_it = graph_nodes_map_.find(node_id);
+  if (graph_node_it == graph_nodes_map_.end())
+  {
+    return no_nodes;
+  }
+  return graph_node_it->second.parent_ids_;
+}
+
+const ActionParameters::BindingPlan& UmrfGraph::getBindingPlanOf(const unsigned int& parent_id
+, const unsigned int& child_index) const
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  static const ActionParameters::BindingPlan unresolved_binding_plan;
+
+  auto graph_node_it = graph_nodes_map_.find(parent_id);
+  if (graph_node_it == graph_nodes_map_.end() || child_index >= graph_node_it->second.child_binding_plans_.size())
+  {
+    return unresolved_binding_plan;
+  }
+  return graph_node_it->second.child_binding_plans_[child_index];
 }
 
 bool UmrfGraph::setNodeState(const unsigned int& node_id, GraphNode::State node_state)
@@ -205,11 +462,29 @@ bool UmrfGraph::setNodeState(const unsigned int& node_id, GraphNode::State node_
   }
   else
   {
-    graph_nodes_map_.at(node_id).state_ = node_state;
+    GraphNode::State& current_node_state = graph_nodes_map_.at(node_id).state_;
+    if (current_node_state != node_state)
+    {
+      getNodeStateCount(current_node_state)--;
+      getNodeStateCount(node_state)++;
+      current_node_state = node_state;
+    }
     return true;
   }
 }
 
+unsigned int& UmrfGraph::getNodeStateCount(const GraphNode::State& node_state)
+{
+  switch(node_state)
+  {
+    case GraphNode::State::UNINITIALIZED : return nr_of_uninitialized_nodes_;
+    case GraphNode::State::INITIALIZED   : return nr_of_initialized_nodes_;
+    case GraphNode::State::ACTIVE        : return nr_of_active_nodes_;
+    case GraphNode::State::FINISHED      : return nr_of_finished_nodes_;
+    default                              : return nr_of_errored_nodes_;
+  }
+}
+
 bool UmrfGraph::setNodeActive(const unsigned int& node_id)
 {
   return setNodeState(node_id, GraphNode::State::ACTIVE);
@@ -227,27 +502,10 @@ bool UmrfGraph::setNodeError(const unsigned int& node_id)
 
 UmrfGraph::State UmrfGraph::checkState()
 {
+  // The node state counters are maintained by setNodeState, hence no need to go through the nodes
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE guard_state_(state_rw_mutex_);
 
-  nr_of_uninitialized_nodes_ = 0;
-  nr_of_initialized_nodes_ = 0;
-  nr_of_active_nodes_ = 0;
-  nr_of_finished_nodes_ = 0;
-  nr_of_errored_nodes_ = 0;
-
-  for (const auto& graph_node_pair : graph_nodes_map_)
-  {
-    switch(graph_node_pair.second.state_)
-    {
-      case GraphNode::State::UNINITIALIZED : nr_of_uninitialized_nodes_++; break;
-      case GraphNode::State::INITIALIZED   : nr_of_initialized_nodes_++; break;
-      case GraphNode::State::ACTIVE        : nr_of_active_nodes_++; break;
-      case GraphNode::State::FINISHED      : nr_of_finished_nodes_++; break;
-      case GraphNode::State::ERROR         : nr_of_errored_nodes_++; break;
-    }
-  }
-
   if (nr_of_errored_nodes_ > 0)
   {
     state_ = UmrfGraph::State::ERROR;
@@ -264,6 +522,12 @@ UmrfGraph::State UmrfGraph::checkState()
   return state_;
 }
 
+bool UmrfGraph::hasActiveNodes() const
+{
+  LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
+  return nr_of_active_nodes_ > 0;
+}
+
 const Umrf& UmrfGraph::getUmrfOf(const unsigned int& node_id) const
 {
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
@@ -301,16 +565,27 @@ const std::vector<Umrf>& UmrfGraph::getUmrfs() const
 }
 
 const unsigned int& UmrfGraph::getNodeId(const std::string& node_name) const
+{
+  const NameAtom node_name_atom = NameAtom::lookup(node_name);
+  if (!node_name_atom.valid())
+  {
+    throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" + node_name + "'");
+  }
+  return getNodeId(node_name_atom);
+}
+
+const unsigned int& UmrfGraph::getNodeId(const NameAtom& node_name) const
 {
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  if (name_id_map_.find(node_name) == name_id_map_.end())
+  auto name_id_it = name_id_map_.find(node_name);
+  if (name_id_it == name_id_map_.end())
   {
-    throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" + node_name + "'");
+    throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" + node_name.str() + "'");
   }
   else
   {
-    return name_id_map_.at(node_name);
+    return name_id_it->second;
   }
 }
 
@@ -331,19 +606,22 @@ void UmrfGraph::addUmrf(const Umrf& umrf)
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  if (partOfGraph(umrf.getFullName()))
+  if (partOfGraph(umrf.getFullNameAtom()))
   {
     throw CREATE_TEMOTO_ERROR_STACK("Cannot add UMRF '" + umrf.getFullName() + "', as it is already part of graph '" 
       + graph_name_ + "'");
   }
 
   graph_nodes_map_.emplace(umrf.getId(), umrf).second;
-  name_id_map_.emplace(umrf.getFullName(), umrf.getId()).second;
+  name_id_map_.emplace(umrf.getFullNameAtom(), umrf.getId()).second;
+  getNodeStateCount(GraphNode::State::UNINITIALIZED)++;
 
   // If the new UMRF has parents then modify the parent UMRFs accordingly
+  std::set<unsigned int> modified_node_ids;
+  collectWithParents(umrf.getId(), modified_node_ids);
   for (const auto& parent_umrf_relation : umrf.getParents())
   {
-    unsigned int parent_node_id = getNodeId(parent_umrf_relation.getFullName());
+    unsigned int parent_node_id = getNodeId(parent_umrf_relation.getFullNameAtom());
     auto parent_node_itr = graph_nodes_map_.find(parent_node_id);
     parent_node_itr->second.umrf_.addChild(umrf.asRelation());
   }
@@ -351,10 +629,13 @@ void UmrfGraph::addUmrf(const Umrf& umrf)
   // If the new UMRF has children then modify the child UMRFs accordingly
   for (const auto& child_umrf_relation : umrf.getChildren())
   {
-    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullName());
+    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullNameAtom());
     auto child_node_itr = graph_nodes_map_.find(child_node_id);
     child_node_itr->second.umrf_.addParent(umrf.asRelation());
+    collectWithParents(child_node_id, modified_node_ids);
   }
+
+  resolveRelations(modified_node_ids);
   return;
 }
 
@@ -363,35 +644,47 @@ unsigned int UmrfGraph::removeUmrf(const Umrf& umrf)
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  if (!partOfGraph(umrf.getFullName()))
+  if (!partOfGraph(umrf.getFullNameAtom()))
   {
     throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" 
       + umrf.getFullName() + "'");
   }
 
-  unsigned int node_id = getNodeId(umrf.getFullName());
+  unsigned int node_id = getNodeId(umrf.getFullNameAtom());
   auto umrf_node_itr = graph_nodes_map_.find(node_id);
 
   // Detach this umrf as a parent of any children
+  std::vector<unsigned int> child_node_ids;
   for (const auto& child_umrf_relation : umrf_node_itr->second.umrf_.getChildren())
   {
-    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullName());
+    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullNameAtom());
     auto child_node_itr = graph_nodes_map_.find(child_node_id);
     child_node_itr->second.umrf_.removeParent(umrf_node_itr->second.umrf_.asRelation());
+    child_node_ids.push_back(child_node_id);
   }
 
   // Detach this umrf as a child of any parents
+  std::set<unsigned int> modified_node_ids;
   for (const auto& parent_umrf_relation : umrf_node_itr->second.umrf_.getParents())
   {
-    unsigned int parent_node_id = getNodeId(parent_umrf_relation.getFullName());
+    unsigned int parent_node_id = getNodeId(parent_umrf_relation.getFullNameAtom());
     auto parent_node_itr = graph_nodes_map_.find(parent_node_id);
     parent_node_itr->second.umrf_.removeChild(umrf_node_itr->second.umrf_.asRelation());
+    modified_node_ids.insert(parent_node_id);
   }
 
   //Remove the umrf node
-  name_id_map_.erase(umrf.getFullName());
+  getNodeStateCount(umrf_node_itr->second.state_)--;
+  name_id_map_.erase(umrf.getFullNameAtom());
   graph_nodes_map_.erase(umrf_node_itr);
 
+  // The parents lists of the children changed, hence also their remaining parents are resolved
+  for (const auto& child_node_id : child_node_ids)
+  {
+    collectWithParents(child_node_id, modified_node_ids);
+  }
+  resolveRelations(modified_node_ids);
+
   //Return the id of the removed umrf node
   return node_id;
 }
@@ -401,22 +694,26 @@ void UmrfGraph::addChild(const Umrf& umrf)
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  if (!partOfGraph(umrf.getFullName()))
+  if (!partOfGraph(umrf.getFullNameAtom()))
   {
     throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" 
       + umrf.getFullName() + "'");
   }
 
-  unsigned int node_id = getNodeId(umrf.getFullName());
+  unsigned int node_id = getNodeId(umrf.getFullNameAtom());
   auto umrf_node_itr = graph_nodes_map_.find(node_id);
 
+  std::set<unsigned int> modified_node_ids;
+  modified_node_ids.insert(node_id);
   for (const auto& child_umrf_relation : umrf.getChildren())
   {
     umrf_node_itr->second.umrf_.addChild(child_umrf_relation);
-    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullName());
+    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullNameAtom());
     auto child_node_itr = graph_nodes_map_.find(child_node_id);
     child_node_itr->second.umrf_.addParent(umrf.asRelation());
+    collectWithParents(child_node_id, modified_node_ids);
   }
+  resolveRelations(modified_node_ids);
 }
 
 void UmrfGraph::removeChild(const Umrf& umrf)
@@ -425,20 +722,24 @@ void UmrfGraph::removeChild(const Umrf& umrf)
   LOCK_GUARD_TYPE_R guard_graph_nodes_map_(graph_nodes_map_rw_mutex_);
   LOCK_GUARD_TYPE_R guard_name_id_map_(name_id_map_rw_mutex_);
 
-  if (!partOfGraph(umrf.getFullName()))
+  if (!partOfGraph(umrf.getFullNameAtom()))
   {
     throw CREATE_TEMOTO_ERROR_STACK("UMRF graph '" + graph_name_ + "' does not contain node named '" 
       + umrf.getFullName() + "'");
   }
 
-  unsigned int umrf_node_id = getNodeId(umrf.getFullName());
+  unsigned int umrf_node_id = getNodeId(umrf.getFullNameAtom());
   auto umrf_node_itr = graph_nodes_map_.find(umrf_node_id);
 
+  std::set<unsigned int> modified_node_ids;
+  modified_node_ids.insert(umrf_node_id);
   for (const auto& child_umrf_relation : umrf.getChildren())
   {
     umrf_node_itr->second.umrf_.removeChild(child_umrf_relation);
-    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullName());
+    unsigned int child_node_id = getNodeId(child_umrf_relation.getFullNameAtom());
     auto child_node_itr = graph_nodes_map_.find(child_node_id);
     child_node_itr->second.umrf_.removeParent(umrf.asRelation());
+    collectWithParents(child_node_id, modified_node_ids);
   }
+  resolveRelations(modified_node_ids);
 }
\ No newline at end of file
@@ -21,13 +21,24 @@
 #include <iostream>
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/stringbuffer.h"
-#include <boost/algorithm/string.hpp>
 
 namespace umrf_json_converter
 {
+/*
+ * The single-pass parsers behind JsonParser::SAX, defined in umrf_json_sax_parser.cpp. They follow the
+ * same rules as the DOM parser
+ */
+Umrf fromUmrfJsonStrSax(const std::string& umrf_json_str, bool as_descriptor);
 
-UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str)
+UmrfGraph fromUmrfGraphJsonStrSax(const std::string& umrf_graph_json_str);
+
+UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str, JsonParser parser)
 {
+  if (parser == JsonParser::SAX)
+  {
+    return fromUmrfGraphJsonStrSax(umrf_graph_json_str);
+  }
+
   try
   {
     rapidjson::Document json_doc;
@@ -54,7 +65,7 @@ UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str)
     }
 
     // Parse the umrf json string to umrf datastructure
-    return UmrfGraph(graph_name, umrf_actions, false);
+    return UmrfGraph(graph_name, std::move(umrf_actions), false);
   }
   catch(TemotoErrorStack e)
   {
@@ -62,8 +73,13 @@ UmrfGraph fromUmrfGraphJsonStr(const std::string& umrf_graph_json_str)
   }
 }
 
-Umrf fromUmrfJsonStr(const std::string& umrf_json_str, bool as_descriptor)
+Umrf fromUmrfJsonStr(const std::string& umrf_json_str, bool as_descriptor, JsonParser parser)
 {
+  if (parser == JsonParser::SAX)
+  {
+    return fromUmrfJsonStrSax(umrf_json_str, as_descriptor);
+  }
+
   rapidjson::Document json_doc;
   json_doc.Parse(umrf_json_str.c_str());
 
@@ -483,8 +499,8 @@ std::vector<Umrf::Relation> parseRelations(const rapidjson::Value& value_in)
     // Parse the required fields
     try
     {
-      relation.name_ = getStringFromValue(getJsonElement(RELATION_FIELDS.name, value_in[i]));
-      relation.suffix_ = getNumberFromValue(getJsonElement(RELATION_FIELDS.suffix, value_in[i]));
+      relation = Umrf::Relation(getStringFromValue(getJsonElement(RELATION_FIELDS.name, value_in[i]))
+        , getNumberFromValue(getJsonElement(RELATION_FIELDS.suffix, value_in[i])));
     }
     catch(TemotoErrorStack e)
     {
@@ -582,7 +598,7 @@ ActionParameters::Parameters parseParameters(const rapidjson::Value& value_in, s
     try
     {
       std::string allowed_val = getStringFromValue(getJsonElement(PVF_FIELDS.allowed_values, value_in));
-      pc.addAllowedData(boost::any(allowed_val));
+      pc.addAllowedData(std::move(allowed_val));
     }
     catch(TemotoErrorStack e)
     {
@@ -597,12 +613,12 @@ ActionParameters::Parameters parseParameters(const rapidjson::Value& value_in, s
       if (type == "string")
       {
         std::string value = getStringFromValue(getJsonElement(PVF_FIELDS.value, value_in));
-        pc.setData(boost::any(value));
+        pc.setData(std::move(value));
       }
       else if (type == "number")
       {
         double value = getNumberFromValue(getJsonElement(PVF_FIELDS.value, value_in));
-        pc.setData(boost::any(value));
+        pc.setData(value);
       }
     }
     catch(TemotoErrorStack e)
@@ -633,97 +649,41 @@ ActionParameters::Parameters parseParameters(const rapidjson::Value& value_in, s
   return action_parameters;
 }
 
-std::string removeFirstToken(const std::vector<std::string>& tokens_in)
-{
-  if (tokens_in.empty())
-  {
-    return std::string("");
-  }
-  else if (tokens_in.size() == 1)
-  {
-    return tokens_in.at(0);
-  }
-  else
-  {
-    std::string name;
-    std::vector<std::string> name_tokens_renamed(tokens_in.begin() + 2, tokens_in.end());
-  
-    for (const auto& name_token : name_tokens_renamed)
-    {
-      if (name_token.empty())
-      {
-        continue;
-      }
-      else if (name.empty())
-      {
-        name += name_token;
-      }
-      else
-      {
-        name += "::" + name_token;
-      }
-    }
-    return name;
-  }
-}
-
 void parseParameter(rapidjson::Value& json_value
 , rapidjson::Document::AllocatorType& allocator
 , const ActionParameters::ParameterContainer& pc)
 {
-  // Split the name of the parameter into tokens
-  std::vector<std::string> name_tokens;
-  boost::split(name_tokens, pc.getName(), boost::is_any_of("::"));
-
-  if (name_tokens.empty())
+  // The name of the parameter is already split into segments, e.g., "pose::position::x"
+  const std::vector<NameAtom>& name_segments = pc.getNamePath().segments;
+  if (name_segments.empty())
   {
     throw CREATE_TEMOTO_ERROR_STACK("No name tokens received");
   }
 
-  // Extract the "first_token" and check if such "sub_json_object" exists in the "input_json_object"
-  if (json_value.HasMember(name_tokens.at(0).c_str()))
+  // Descend to the json object of the namespace, creating the missing objects on the way
+  rapidjson::Value* json_object = &json_value;
+  for (auto segment_it = name_segments.begin(); segment_it != name_segments.end() - 1; ++segment_it)
   {
-    // IF there are more tokens left then:
-    if(name_tokens.size() > 1)
+    auto member_it = json_object->FindMember(segment_it->str().c_str());
+    if (member_it == json_object->MemberEnd())
     {
-      // Rename the "parameter" by removing the first token and leaving the rest as "renamed_parameter"
-      ActionParameters::ParameterContainer renamed_param = pc;
-      renamed_param.setName(removeFirstToken(name_tokens));
-
-      // Recursively invoke parseParameter("sub_json_object", "renamed_parameter")
-      parseParameter(json_value[name_tokens.at(0).c_str()], allocator, renamed_param);
-    }
-    else
-    {
-      // Throw an error, because it's a duplicate entry
-      throw CREATE_TEMOTO_ERROR_STACK("Duplicate entry detected");
+      // The interned names are never freed, hence the json can refer to them without copying
+      rapidjson::Value new_json_name(rapidjson::StringRef(segment_it->str().c_str(), segment_it->str().size()));
+      rapidjson::Value new_json_value(rapidjson::kObjectType);
+      json_object->AddMember(new_json_name, new_json_value, allocator);
+      member_it = json_object->MemberEnd() - 1;
     }
+    json_object = &member_it->value;
   }
-  else
-  {
-    if(name_tokens.size() > 1)
-    {
-      // Rename the "parameter" by removing the first token and leaving the rest as "renamed_parameter"
-      ActionParameters::ParameterContainer renamed_param = pc;
-      renamed_param.setName(removeFirstToken(name_tokens));
-
-      // Create new json object and Recursively invoke parseParameter
-      rapidjson::Value new_json_name(rapidjson::kStringType);
-      new_json_name.SetString(name_tokens.at(0).c_str(), name_tokens.at(0).size(), allocator);
 
-      rapidjson::Value new_json_value(rapidjson::kObjectType);
-      parseParameter(new_json_value, allocator, renamed_param);
-
-      json_value.AddMember(new_json_name, new_json_value, allocator);
-      return;
-    }
-    else
-    {
-      // Parse the all the pvf_values of the parameter and insert them to the json object
-      parsePvfFields(json_value, allocator, pc);
-      return;
-    }
+  if (json_object->HasMember(name_segments.back().str().c_str()))
+  {
+    // Throw an error, because it's a duplicate entry
+    throw CREATE_TEMOTO_ERROR_STACK("Duplicate entry detected");
   }
+
+  // Parse the all the pvf_values of the parameter and insert them to the json object
+  parsePvfFields(*json_object, allocator, pc);
 }
 
 void parsePvfFields(
@@ -732,7 +692,7 @@ void parsePvfFields(
   const ActionParameters::ParameterContainer& parameter)
 {
   rapidjson::Value parameter_name(rapidjson::kStringType);
-  parameter_name.SetString(parameter.getName().c_str(), parameter.getName().size(), allocator);
+  parameter_name.SetString(parameter.getNameNoNamespace().c_str(), parameter.getNameNoNamespace().size(), allocator);
 
   rapidjson::Value pvf_value_json_value(rapidjson::kStringType);
   rapidjson::Value pvf_type_json_value(rapidjson::kStringType);
@@ -752,7 +712,7 @@ void parsePvfFields(
 
     if (parameter.getDataSize() != 0)
     {
-      std::string pvf_value_str = boost::any_cast<std::string>(parameter.getData());
+      const std::string pvf_value_str = parameter.getData().get<std::string>();
       rapidjson::Value pvf_value(rapidjson::kStringType);
       pvf_value.SetString(pvf_value_str.c_str(), pvf_value_str.size(), allocator);
       parameter_value.AddMember(pvf_value_json_value, pvf_value, allocator);
@@ -764,7 +724,7 @@ void parsePvfFields(
 
     if (parameter.getDataSize() != 0)
     {
-      double pvf_value_number = boost::any_cast<double>(parameter.getData());
+      double pvf_value_number = parameter.getData().get<double>();
       rapidjson::Value pvf_value(rapidjson::kNumberType);
       pvf_value.SetDouble(pvf_value_number);
       parameter_value.AddMember(pvf_value_json_value, pvf_value, allocator);
@@ -794,7 +754,7 @@ void parsePvfFields(
   // Parse allowed values
   if (!parameter.getAllowedData().empty())
   {
-    std::string pvf_allowed_data = boost::any_cast<std::string>(parameter.getAllowedData().front());
+    std::string pvf_allowed_data = parameter.getAllowedData().front().get<std::string>();
     rapidjson::Value pvf_allowed_data_value(rapidjson::kStringType);
     pvf_allowed_data_value.SetString(pvf_allowed_data.c_str(), pvf_allowed_data.size(), allocator);
     parameter_value.AddMember(pvf_allowed_values_json_value, pvf_allowed_data_value, allocator);
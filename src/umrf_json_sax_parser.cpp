@@ -0,0 +1,820 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * Copyright 2020 TeMoto Telerobotics
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "temoto_action_engine/umrf_json_converter.h"
+#include "temoto_action_engine/temoto_error.h"
+#include "rapidjson/reader.h"
+
+namespace umrf_json_converter
+{
+namespace
+{
+/**
+ * @brief Builds UMRFs directly from the SAX events of the rapidjson reader, i.e., without constructing a
+ * JSON document. Follows the rules of the DOM based parser (fromUmrfJsonValue): missing or ill formatted
+ * required fields are errors, ill formatted optional fields are ignored and ill formatted parameters are
+ * dropped. Optional fields do not raise exceptions.
+ *
+ */
+class UmrfSaxHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, UmrfSaxHandler>
+{
+public:
+  UmrfSaxHandler(bool parse_graph, bool as_descriptor)
+  : parse_graph_(parse_graph)
+  , as_descriptor_(as_descriptor)
+  {}
+
+  bool Null()
+  {
+    return onScalar(Scalar());
+  }
+
+  bool Bool(bool boolean)
+  {
+    Scalar scalar(Scalar::Type::BOOL);
+    scalar.boolean = boolean;
+    return onScalar(scalar);
+  }
+
+  bool Int(int number)
+  {
+    return Double(number);
+  }
+
+  bool Uint(unsigned number)
+  {
+    return Double(number);
+  }
+
+  bool Int64(int64_t number)
+  {
+    return Double(number);
+  }
+
+  bool Uint64(uint64_t number)
+  {
+    return Double(number);
+  }
+
+  bool Double(double number)
+  {
+    Scalar scalar(Scalar::Type::NUMBER);
+    scalar.number = number;
+    return onScalar(scalar);
+  }
+
+  bool RawNumber(const char* str, rapidjson::SizeType length, bool copy)
+  {
+    return String(str, length, copy);
+  }
+
+  bool String(const char* str, rapidjson::SizeType length, bool /*copy*/)
+  {
+    Scalar scalar(Scalar::Type::STRING);
+    scalar.string = str;
+    scalar.length = length;
+    return onScalar(scalar);
+  }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool /*copy*/)
+  {
+    key_.assign(str, length);
+    return true;
+  }
+
+  bool StartObject();
+
+  bool EndObject(rapidjson::SizeType /*member_count*/);
+
+  bool StartArray();
+
+  bool EndArray(rapidjson::SizeType /*element_count*/);
+
+  const std::string& getError() const
+  {
+    return error_;
+  }
+
+  Umrf& getUmrf()
+  {
+    return umrf_;
+  }
+
+  UmrfGraph getUmrfGraph()
+  {
+    return UmrfGraph(graph_name_, std::move(umrfs_), false);
+  }
+
+private:
+  enum class Context
+  {
+    GRAPH,
+    UMRF_ACTIONS,
+    UMRF,
+    RELATIONS,
+    RELATION,
+    PARAMETERS,
+    SKIPPED
+  };
+
+  struct Scalar
+  {
+    enum class Type
+    {
+      NUL,
+      BOOL,
+      NUMBER,
+      STRING
+    };
+
+    Scalar(Type type_in = Type::NUL)
+    : type(type_in)
+    {}
+
+    std::string str() const
+    {
+      return std::string(string, length);
+    }
+
+    Type type;
+    bool boolean = false;
+    double number = 0;
+    const char* string = nullptr;
+    rapidjson::SizeType length = 0;
+  };
+
+  /// Parameters of a JSON object in the parameters tree, see parseParameters
+  struct ParameterFrame
+  {
+    ParameterFrame(std::string name_in)
+    : name(std::move(name_in))
+    {}
+
+    std::string name;
+    ActionParameters::Parameters parameters;
+
+    /// The object has members which are not objects (or such descendants), i.e., it's ill formatted unless
+    /// it's a parameter. As by the DOM parser, this applies also to the pvf fields of an object without a pvf_type
+    bool malformed = false;
+
+    bool has_type = false;
+    bool has_value = false;
+    std::string type;
+    Scalar value;
+    std::string value_string;
+    std::string required;
+    std::string updatable;
+    std::string example;
+    std::string allowed_value;
+  };
+
+  bool fail(const std::string& error)
+  {
+    error_ = error;
+    return false;
+  }
+
+  bool onScalar(const Scalar& scalar);
+
+  bool onUmrfScalar(const Scalar& scalar);
+
+  bool onRelationScalar(const Scalar& scalar);
+
+  bool onParameterScalar(const Scalar& scalar);
+
+  bool finishUmrf();
+
+  bool finishRelation();
+
+  void finishParameters();
+
+  static bool isPvfField(const std::string& key);
+
+  static double toNumber(double number)
+  {
+    // The DOM parser reads the numbers as floats
+    return static_cast<float>(number);
+  }
+
+  bool parse_graph_;
+  bool as_descriptor_;
+  std::string error_;
+  std::string key_;
+  std::vector<Context> contexts_;
+
+  std::string graph_name_;
+  bool has_graph_name_ = false;
+  bool has_umrf_actions_ = false;
+  std::vector<Umrf> umrfs_;
+
+  Umrf umrf_;
+  bool has_name_ = false;
+  bool has_effect_ = false;
+  bool has_package_name_ = false;
+  bool has_suffix_ = false;
+
+  /// Whether the relations that are being parsed are parents or children
+  bool parsing_parents_ = false;
+  std::vector<Umrf::Relation> relations_;
+  std::string relation_name_;
+  unsigned int relation_suffix_ = 0;
+  bool relation_required_ = true;
+  bool has_relation_name_ = false;
+  bool has_relation_suffix_ = false;
+
+  /// Whether the parameters that are being parsed are input or output parameters
+  bool parsing_input_parameters_ = false;
+  std::vector<ParameterFrame> parameter_frames_;
+};
+
+bool UmrfSaxHandler::onScalar(const Scalar& scalar)
+{
+  if (contexts_.empty())
+  {
+    return fail("The JSON must be an object.");
+  }
+
+  switch (contexts_.back())
+  {
+    case Context::GRAPH:
+      if (key_ == UMRF_FIELDS.graph_name)
+      {
+        if (scalar.type != Scalar::Type::STRING)
+        {
+          return fail("This JSON value is not a string");
+        }
+        graph_name_ = scalar.str();
+        has_graph_name_ = true;
+      }
+      else if (key_ == UMRF_FIELDS.umrf_actions)
+      {
+        return fail("The umrf_actions field must be an array");
+      }
+      return true;
+
+    case Context::UMRF_ACTIONS:
+      return fail("The umrf_actions field must contain JSON objects");
+
+    case Context::UMRF:
+      return onUmrfScalar(scalar);
+
+    case Context::RELATIONS:
+      return fail("The relations field must contain JSON objects");
+
+    case Context::RELATION:
+      return onRelationScalar(scalar);
+
+    case Context::PARAMETERS:
+      return onParameterScalar(scalar);
+
+    default:
+      return true;
+  }
+}
+
+bool UmrfSaxHandler::onUmrfScalar(const Scalar& scalar)
+{
+  if (key_ == UMRF_FIELDS.name)
+  {
+    if (scalar.type != Scalar::Type::STRING)
+    {
+      return fail("This JSON value is not a string");
+    }
+    if (!umrf_.setName(scalar.str()))
+    {
+      return fail("Illegal value in name field.");
+    }
+    has_name_ = true;
+  }
+  else if (key_ == UMRF_FIELDS.effect)
+  {
+    if (scalar.type != Scalar::Type::STRING)
+    {
+      return fail("This JSON value is not a string");
+    }
+    if (!umrf_.setEffect(scalar.str()))
+    {
+      return fail("Illegal value in effect field.");
+    }
+    has_effect_ = true;
+  }
+  else if (key_ == UMRF_FIELDS.package_name && as_descriptor_)
+  {
+    if (scalar.type != Scalar::Type::STRING)
+    {
+      return fail("This JSON value is not a string");
+    }
+    if (!umrf_.setPackageName(scalar.str()))
+    {
+      return fail("Illegal value in package_name field.");
+    }
+    has_package_name_ = true;
+  }
+  else if (key_ == UMRF_FIELDS.suffix && !as_descriptor_)
+  {
+    if (scalar.type != Scalar::Type::NUMBER)
+    {
+      return fail("This JSON value is not a number");
+    }
+    if (!umrf_.setSuffix(toNumber(scalar.number)))
+    {
+      return fail("Illegal value in suffix field.");
+    }
+    has_suffix_ = true;
+  }
+  else if (key_ == UMRF_FIELDS.library_path)
+  {
+    if (scalar.type == Scalar::Type::STRING)
+    {
+      umrf_.setLibraryPath(scalar.str());
+    }
+  }
+  else if (key_ == UMRF_FIELDS.description)
+  {
+    if (scalar.type == Scalar::Type::STRING)
+    {
+      umrf_.setDescription(scalar.str());
+    }
+  }
+  else if (key_ == UMRF_FIELDS.parents || key_ == UMRF_FIELDS.children)
+  {
+    return fail("The relations field must be an array");
+  }
+  return true;
+}
+
+bool UmrfSaxHandler::onRelationScalar(const Scalar& scalar)
+{
+  if (key_ == RELATION_FIELDS.name)
+  {
+    if (scalar.type != Scalar::Type::STRING)
+    {
+      return fail("This JSON value is not a string");
+    }
+    relation_name_ = scalar.str();
+    has_relation_name_ = true;
+  }
+  else if (key_ == RELATION_FIELDS.suffix)
+  {
+    if (scalar.type != Scalar::Type::NUMBER)
+    {
+      return fail("This JSON value is not a number");
+    }
+    relation_suffix_ = toNumber(scalar.number);
+    has_relation_suffix_ = true;
+  }
+  else if (key_ == RELATION_FIELDS.required)
+  {
+    if (scalar.type == Scalar::Type::BOOL)
+    {
+      relation_required_ = scalar.boolean;
+    }
+  }
+  return true;
+}
+
+bool UmrfSaxHandler::onParameterScalar(const Scalar& scalar)
+{
+  // Only parameters (objects with a pvf_type) can have non-object members. The pvf_type might come after
+  // the other members, hence the object is checked once it's completed
+  ParameterFrame& frame = parameter_frames_.back();
+  frame.malformed = true;
+  if (!isPvfField(key_))
+  {
+    return true;
+  }
+
+  if (key_ == PVF_FIELDS.type)
+  {
+    if (scalar.type == Scalar::Type::STRING)
+    {
+      frame.type = scalar.str();
+      frame.has_type = true;
+    }
+    return true;
+  }
+  else if (key_ == PVF_FIELDS.value)
+  {
+    frame.value = scalar;
+    if (scalar.type == Scalar::Type::STRING)
+    {
+      // The string is not valid after this event, so it is kept until the parameter is completed
+      frame.value_string = scalar.str();
+    }
+    frame.has_value = true;
+    return true;
+  }
+
+  if (scalar.type != Scalar::Type::STRING)
+  {
+    return true;
+  }
+  if (key_ == PVF_FIELDS.required)
+  {
+    frame.required = scalar.str();
+  }
+  else if (key_ == PVF_FIELDS.updatable)
+  {
+    frame.updatable = scalar.str();
+  }
+  else if (key_ == PVF_FIELDS.example)
+  {
+    frame.example = scalar.str();
+  }
+  else if (key_ == PVF_FIELDS.allowed_values)
+  {
+    frame.allowed_value = scalar.str();
+  }
+  return true;
+}
+
+bool UmrfSaxHandler::StartObject()
+{
+  if (contexts_.empty())
+  {
+    contexts_.push_back(parse_graph_ ? Context::GRAPH : Context::UMRF);
+    return true;
+  }
+
+  switch (contexts_.back())
+  {
+    case Context::GRAPH:
+      if (key_ == UMRF_FIELDS.graph_name)
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == UMRF_FIELDS.umrf_actions)
+      {
+        return fail("The umrf_actions field must be an array");
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::UMRF_ACTIONS:
+      umrf_ = Umrf();
+      has_name_ = false;
+      has_effect_ = false;
+      has_package_name_ = false;
+      has_suffix_ = false;
+      contexts_.push_back(Context::UMRF);
+      return true;
+
+    case Context::UMRF:
+      if (key_ == UMRF_FIELDS.input_parameters || key_ == UMRF_FIELDS.output_parameters)
+      {
+        parsing_input_parameters_ = (key_ == UMRF_FIELDS.input_parameters);
+        parameter_frames_.clear();
+        parameter_frames_.emplace_back("");
+        contexts_.push_back(Context::PARAMETERS);
+        return true;
+      }
+      else if (key_ == UMRF_FIELDS.parents || key_ == UMRF_FIELDS.children)
+      {
+        return fail("The relations field must be an array");
+      }
+      else if (key_ == UMRF_FIELDS.name || key_ == UMRF_FIELDS.effect || (key_ == UMRF_FIELDS.package_name && as_descriptor_))
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == UMRF_FIELDS.suffix && !as_descriptor_)
+      {
+        return fail("This JSON value is not a number");
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::RELATIONS:
+      relation_required_ = true;
+      has_relation_name_ = false;
+      has_relation_suffix_ = false;
+      contexts_.push_back(Context::RELATION);
+      return true;
+
+    case Context::RELATION:
+      if (key_ == RELATION_FIELDS.name)
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == RELATION_FIELDS.suffix)
+      {
+        return fail("This JSON value is not a number");
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::PARAMETERS:
+    {
+      ParameterFrame& frame = parameter_frames_.back();
+      if (key_ == PVF_FIELDS.type)
+      {
+        frame.malformed = true;
+        contexts_.push_back(Context::SKIPPED);
+        return true;
+      }
+
+      // The object members of a parameter are ignored once the parameter is completed (see finishParameters). As
+      // by the DOM parser, the pvf fields of an object without a pvf_type are parsed as nested parameters
+      std::string name = frame.name.empty() ? key_ : frame.name + "::" + key_;
+      parameter_frames_.emplace_back(std::move(name));
+      contexts_.push_back(Context::PARAMETERS);
+      return true;
+    }
+
+    default:
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+  }
+}
+
+bool UmrfSaxHandler::EndObject(rapidjson::SizeType /*member_count*/)
+{
+  Context context = contexts_.back();
+  contexts_.pop_back();
+
+  switch (context)
+  {
+    case Context::GRAPH:
+      if (!has_graph_name_)
+      {
+        return fail("This JSON does not contain element '" + std::string(UMRF_FIELDS.graph_name) + "'");
+      }
+      if (!has_umrf_actions_)
+      {
+        return fail("This JSON does not contain element '" + std::string(UMRF_FIELDS.umrf_actions) + "'");
+      }
+      return true;
+
+    case Context::UMRF:
+      return finishUmrf();
+
+    case Context::RELATION:
+      return finishRelation();
+
+    case Context::PARAMETERS:
+      finishParameters();
+      return true;
+
+    default:
+      return true;
+  }
+}
+
+bool UmrfSaxHandler::StartArray()
+{
+  if (contexts_.empty())
+  {
+    return fail("The JSON must be an object.");
+  }
+
+  switch (contexts_.back())
+  {
+    case Context::GRAPH:
+      if (key_ == UMRF_FIELDS.graph_name)
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == UMRF_FIELDS.umrf_actions)
+      {
+        has_umrf_actions_ = true;
+        contexts_.push_back(Context::UMRF_ACTIONS);
+        return true;
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::UMRF_ACTIONS:
+      return fail("The umrf_actions field must contain JSON objects");
+
+    case Context::UMRF:
+      if (key_ == UMRF_FIELDS.parents || key_ == UMRF_FIELDS.children)
+      {
+        parsing_parents_ = (key_ == UMRF_FIELDS.parents);
+        relations_.clear();
+        contexts_.push_back(Context::RELATIONS);
+        return true;
+      }
+      else if (key_ == UMRF_FIELDS.name || key_ == UMRF_FIELDS.effect || (key_ == UMRF_FIELDS.package_name && as_descriptor_))
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == UMRF_FIELDS.suffix && !as_descriptor_)
+      {
+        return fail("This JSON value is not a number");
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::RELATIONS:
+      return fail("The relations field must contain JSON objects");
+
+    case Context::RELATION:
+      if (key_ == RELATION_FIELDS.name)
+      {
+        return fail("This JSON value is not a string");
+      }
+      else if (key_ == RELATION_FIELDS.suffix)
+      {
+        return fail("This JSON value is not a number");
+      }
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+
+    case Context::PARAMETERS:
+    {
+      // Arrays are allowed only as members of parameters, see onParameterScalar
+      parameter_frames_.back().malformed = true;
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+    }
+
+    default:
+      contexts_.push_back(Context::SKIPPED);
+      return true;
+  }
+}
+
+bool UmrfSaxHandler::EndArray(rapidjson::SizeType /*element_count*/)
+{
+  Context context = contexts_.back();
+  contexts_.pop_back();
+
+  if (context == Context::RELATIONS)
+  {
+    if (parsing_parents_)
+    {
+      umrf_.setParents(relations_);
+    }
+    else
+    {
+      umrf_.setChildren(relations_);
+    }
+  }
+  return true;
+}
+
+bool UmrfSaxHandler::finishUmrf()
+{
+  const char* missing_field = nullptr;
+  if (!has_name_)
+  {
+    missing_field = UMRF_FIELDS.name;
+  }
+  else if (!has_effect_)
+  {
+    missing_field = UMRF_FIELDS.effect;
+  }
+  else if (as_descriptor_ && !has_package_name_)
+  {
+    missing_field = UMRF_FIELDS.package_name;
+  }
+  else if (!as_descriptor_ && !has_suffix_)
+  {
+    missing_field = UMRF_FIELDS.suffix;
+  }
+
+  if (missing_field != nullptr)
+  {
+    return fail("This JSON does not contain element '" + std::string(missing_field) + "'");
+  }
+
+  // The root UMRF is retrieved via getUmrf
+  if (!contexts_.empty())
+  {
+    umrfs_.push_back(std::move(umrf_));
+  }
+  return true;
+}
+
+bool UmrfSaxHandler::finishRelation()
+{
+  if (!has_relation_name_)
+  {
+    return fail("This field does not contain element '" + std::string(RELATION_FIELDS.name) + "'");
+  }
+  if (!has_relation_suffix_)
+  {
+    return fail("This field does not contain element '" + std::string(RELATION_FIELDS.suffix) + "'");
+  }
+  relations_.push_back(Umrf::Relation(relation_name_, relation_suffix_, relation_required_));
+  return true;
+}
+
+void UmrfSaxHandler::finishParameters()
+{
+  ParameterFrame frame = std::move(parameter_frames_.back());
+  parameter_frames_.pop_back();
+
+  ActionParameters::Parameters parameters;
+  bool malformed = false;
+  if (frame.has_type)
+  {
+    // The object is a parameter, its other members are ignored even if they are ill formatted
+    ActionParameters::ParameterContainer pc(frame.name, frame.type);
+    if (!frame.required.empty())
+    {
+      pc.setRequired(frame.required == "true");
+    }
+    if (!frame.updatable.empty())
+    {
+      pc.setUpdatable(frame.updatable == "true");
+    }
+    if (!frame.example.empty())
+    {
+      pc.setExample(frame.example);
+    }
+    if (!frame.allowed_value.empty())
+    {
+      pc.addAllowedData(frame.allowed_value);
+    }
+    if (frame.has_value)
+    {
+      if (frame.type == "string" && frame.value.type == Scalar::Type::STRING)
+      {
+        pc.setData(std::move(frame.value_string));
+      }
+      else if (frame.type == "number" && frame.value.type == Scalar::Type::NUMBER)
+      {
+        pc.setData(toNumber(frame.value.number));
+      }
+    }
+    parameters.insert(std::move(pc));
+  }
+  else
+  {
+    parameters = std::move(frame.parameters);
+    malformed = frame.malformed;
+  }
+
+  if (!parameter_frames_.empty())
+  {
+    parameter_frames_.back().parameters.insert(parameters.begin(), parameters.end());
+    parameter_frames_.back().malformed |= malformed;
+  }
+  else if (!malformed)
+  {
+    // Ill formatted parameters are dropped, as by the DOM parser
+    if (parsing_input_parameters_)
+    {
+      umrf_.setInputParameters(parameters);
+    }
+    else
+    {
+      umrf_.setOutputParameters(parameters);
+    }
+  }
+}
+
+bool UmrfSaxHandler::isPvfField(const std::string& key)
+{
+  return (key == PVF_FIELDS.type ||
+    key == PVF_FIELDS.value ||
+    key == PVF_FIELDS.example ||
+    key == PVF_FIELDS.required ||
+    key == PVF_FIELDS.updatable ||
+    key == PVF_FIELDS.allowed_values);
+}
+
+void parseWithSax(const std::string& json_str, UmrfSaxHandler& handler)
+{
+  rapidjson::Reader reader;
+  rapidjson::StringStream json_stream(json_str.c_str());
+  if (!reader.Parse(json_stream, handler))
+  {
+    if (!handler.getError().empty())
+    {
+      throw CREATE_TEMOTO_ERROR_STACK(handler.getError());
+    }
+    throw CREATE_TEMOTO_ERROR_STACK("The provided JSON string contains syntax errors.");
+  }
+}
+} // anonymous namespace
+
+// Declared in umrf_json_converter.cpp, selected via JsonParser::SAX
+Umrf fromUmrfJsonStrSax(const std::string& umrf_json_str, bool as_descriptor)
+{
+  UmrfSaxHandler handler(false, as_descriptor);
+  parseWithSax(umrf_json_str, handler);
+  return std::move(handler.getUmrf());
+}
+
+UmrfGraph fromUmrfGraphJsonStrSax(const std::string& umrf_graph_json_str)
+{
+  UmrfSaxHandler handler(true, false);
+  parseWithSax(umrf_graph_json_str, handler);
+  return handler.getUmrfGraph();
+}
+
+} // umrf_json_converter namespace